@@ -92,6 +92,31 @@ void QtnMultiProperty::addProperty(QtnProperty *property, bool own)
 		&QtnMultiProperty::onPropertyDidChange);
 }
 
+void QtnMultiProperty::removeProperty(QtnProperty *property)
+{
+	auto it = std::find(properties.begin(), properties.end(), property);
+	if (it == properties.end())
+		return;
+
+	properties.erase(it);
+
+	if (property->parent() == this)
+		property->setParent(nullptr);
+
+	QObject::disconnect(property, &QtnProperty::propertyValueAccept, this,
+		&QtnMultiProperty::onPropertyValueAccept);
+	QObject::disconnect(property, &QtnPropertyBase::propertyWillChange, this,
+		&QtnMultiProperty::onPropertyWillChange);
+	QObject::disconnect(property, &QtnPropertyBase::propertyDidChange, this,
+		&QtnMultiProperty::onPropertyDidChange);
+
+	if (!properties.empty())
+	{
+		updateStateFrom(properties.front());
+		updateMultipleState(true);
+	}
+}
+
 void QtnMultiProperty::doReset(QtnPropertyChangeReason reason)
 {
 	Q_ASSERT(reason & QtnPropertyChangeReasonResetValue);
@@ -39,6 +39,7 @@ public:
 	virtual const QMetaObject *propertyMetaObject() const override;
 
 	void addProperty(QtnProperty *property, bool own = true);
+	void removeProperty(QtnProperty *property);
 
 	bool hasMultipleValues() const;
 
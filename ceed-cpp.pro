@@ -73,6 +73,8 @@ SOURCES += \
     src/ui/widgets/BitmapEditorWidget.cpp \
     src/cegui/CEGUIManager.cpp \
     src/cegui/CEGUIProject.cpp \
+    src/cegui/CEGUIResourcePrefetcher.cpp \
+    src/cegui/CEGUIWidgetSerializer.cpp \
     src/cegui/CEGUIProjectItem.cpp \
     src/cegui/CEGUIManipulator.cpp \
     src/cegui/QtnPropertyUDim.cpp \
@@ -99,15 +101,22 @@ SOURCES += \
     src/editors/layout/LayoutCodeMode.cpp \
     src/editors/imageset/ImagesetCodeMode.cpp \
     src/editors/layout/LayoutPreviewerMode.cpp \
+    src/editors/layout/LayoutBatchRenderer.cpp \
+    src/editors/layout/LayoutBenchmark.cpp \
     src/editors/imageset/ImagesetVisualMode.cpp \
     src/ui/imageset/ImagesetEditorDockWidget.cpp \
     src/ui/ResizableGraphicsView.cpp \
     src/ui/imageset/ImageLabel.cpp \
     src/ui/imageset/ImageOffsetMark.cpp \
     src/ui/imageset/ImageEntry.cpp \
+    src/ui/imageset/ImageListModel.cpp \
     src/ui/imageset/ImagesetEntry.cpp \
     src/util/Utils.cpp \
+    src/util/FrameProfiler.cpp \
+    src/util/ImageService.cpp \
+    src/ui/FrameProfilerOverlay.cpp \
     src/ui/ResizableRectItem.cpp \
+    src/ui/TiledImageItem.cpp \
     src/ui/ResizingHandle.cpp \
     src/editors/imageset/ImagesetUndoCommands.cpp \
     src/ui/widgets/LineEditWithClearButton.cpp \
@@ -116,6 +125,7 @@ SOURCES += \
     src/ui/layout/WidgetHierarchyTreeView.cpp \
     src/ui/layout/LayoutManipulator.cpp \
     src/ui/layout/LayoutScene.cpp \
+    src/ui/layout/LayoutOverlapIndex.cpp \
     src/ui/layout/WidgetHierarchyTreeModel.cpp \
     src/ui/layout/WidgetHierarchyDockWidget.cpp \
     src/ui/XMLSyntaxHighlighter.cpp \
@@ -153,6 +163,8 @@ HEADERS += \
     src/ui/CEGUIGraphicsScene.h \
     src/cegui/CEGUIManager.h \
     src/cegui/CEGUIProject.h \
+    src/cegui/CEGUIResourcePrefetcher.h \
+    src/cegui/CEGUIWidgetSerializer.h \
     src/cegui/CEGUIProjectItem.h \
     src/cegui/CEGUIManipulator.h \
     src/cegui/QtnPropertyUDim.h \
@@ -200,15 +212,23 @@ HEADERS += \
     src/editors/layout/LayoutCodeMode.h \
     src/editors/imageset/ImagesetCodeMode.h \
     src/editors/layout/LayoutPreviewerMode.h \
+    src/editors/layout/LayoutBatchRenderer.h \
+    src/editors/layout/LayoutBenchmark.h \
     src/editors/imageset/ImagesetVisualMode.h \
     src/ui/imageset/ImagesetEditorDockWidget.h \
     src/ui/ResizableGraphicsView.h \
     src/ui/imageset/ImageLabel.h \
     src/ui/imageset/ImageOffsetMark.h \
     src/ui/imageset/ImageEntry.h \
+    src/ui/imageset/ImageListModel.h \
     src/ui/imageset/ImagesetEntry.h \
     src/util/Utils.h \
+    src/util/FrameProfiler.h \
+    src/util/ImageService.h \
+    src/util/FunctionTask.h \
+    src/ui/FrameProfilerOverlay.h \
     src/ui/ResizableRectItem.h \
+    src/ui/TiledImageItem.h \
     src/ui/ResizingHandle.h \
     src/editors/imageset/ImagesetUndoCommands.h \
     src/ui/widgets/LineEditWithClearButton.h \
@@ -217,6 +237,7 @@ HEADERS += \
     src/ui/layout/WidgetHierarchyTreeView.h \
     src/ui/layout/LayoutManipulator.h \
     src/ui/layout/LayoutScene.h \
+    src/ui/layout/LayoutOverlapIndex.h \
     src/ui/layout/WidgetHierarchyTreeModel.h \
     src/ui/layout/WidgetHierarchyDockWidget.h \
     src/ui/XMLSyntaxHighlighter.h \
@@ -6,6 +6,8 @@
 #include "src/util/Utils.h"
 #include "src/editors/imageset/ImagesetEditor.h"
 #include "src/editors/layout/LayoutEditor.h"
+#include "src/editors/layout/LayoutBatchRenderer.h"
+#include "src/editors/layout/LayoutBenchmark.h"
 #include "src/editors/looknfeel/LookNFeelEditor.h"
 #include "src/ui/dialogs/UpdateDialog.h"
 #include <qsplashscreen.h>
@@ -21,6 +23,7 @@
 #include <qjsondocument.h>
 #include <qjsonobject.h>
 #include <qversionnumber.h>
+#include <qtimer.h>
 
 Application::Application(int& argc, char** argv)
     : QApplication(argc, argv)
@@ -41,8 +44,29 @@ Application::Application(int& argc, char** argv)
     // Finally read stored values into our new setting entries
     _settings->load();
 
+    _cmdLine = new QCommandLineParser();
+    _cmdLine->setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+    _cmdLine->addOptions(
+    {
+        { "updateResult", tr("Update result code, 0 if succeeded."), tr("updateResult") },
+        { "updateMessage", tr("Update results messaged by an updater."), tr("updateMessage") },
+    });
+    LayoutBatchRenderer::addCommandLineOptions(*_cmdLine);
+    LayoutBenchmark::addCommandLineOptions(*_cmdLine);
+    _cmdLine->process(*this);
+
+    // Batch rendering works without UI and exits when finished
+    if (LayoutBatchRenderer::isRequested(*_cmdLine))
+    {
+        _batchRenderer = new LayoutBatchRenderer(*_cmdLine);
+        QTimer::singleShot(0, this, [this]() { exit(_batchRenderer->run()); });
+        return;
+    }
+
+    const bool benchmark = LayoutBenchmark::isRequested(*_cmdLine);
+
     QSplashScreen* splash = nullptr;
-    if (_settings->getEntryValue("global/app/show_splash").toBool())
+    if (!benchmark && _settings->getEntryValue("global/app/show_splash").toBool())
     {
         splash = new QSplashScreen(QPixmap(":/images/splashscreen.png"));
         splash->setWindowModality(Qt::ApplicationModal);
@@ -55,15 +79,6 @@ Application::Application(int& argc, char** argv)
         processEvents();
     }
 
-    _cmdLine = new QCommandLineParser();
-    _cmdLine->setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
-    _cmdLine->addOptions(
-    {
-        { "updateResult", tr("Update result code, 0 if succeeded."), tr("updateResult") },
-        { "updateMessage", tr("Update results messaged by an updater."), tr("updateMessage") },
-    });
-    _cmdLine->process(*this);
-
     _network = new QNetworkAccessManager(this);
 
     _mainWindow = new MainWindow();
@@ -71,6 +86,14 @@ Application::Application(int& argc, char** argv)
     ImagesetEditor::createToolbar(*this);
     LayoutEditor::createToolbar(*this);
 
+    // Benchmark needs real editors and therefore the main window, but never shows it and exits when finished
+    if (benchmark)
+    {
+        _benchmark = new LayoutBenchmark(*_cmdLine);
+        QTimer::singleShot(0, this, [this]() { exit(_benchmark->run()); });
+        return;
+    }
+
     if (splash)
     {
         splash->finish(_mainWindow);
@@ -121,6 +144,8 @@ Application::Application(int& argc, char** argv)
 
 Application::~Application()
 {
+    delete _batchRenderer;
+    delete _benchmark;
     delete _mainWindow;
     delete _settings;
     delete _cmdLine;
@@ -495,6 +520,14 @@ void Application::createSettingsEntries()
                                   "colour", false, 4));
     secBG->addEntry(std::move(entry));
 
+    auto secRendering = catCEGUI->createSection("rendering", "Rendering");
+
+    entry.reset(new SettingsEntry(*secRendering, "offscreen_cache_size", 256, "Offscreen frame cache (MB)",
+                                  "Video memory for keeping the last rendered frames of open editors. They are shown instantly\n"
+                                  "when switching tabs. When the limit is exceeded, least recently shown frames are dropped.",
+                                  "int", false, 1));
+    secRendering->addEntry(std::move(entry));
+
     auto secScreenshots = catCEGUI->createSection("screenshots", "Screenshots");
 
     entry.reset(new SettingsEntry(*secScreenshots, "save", true, "Save to file",
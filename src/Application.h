@@ -11,6 +11,8 @@ class Settings;
 class SettingsSection;
 class QNetworkAccessManager;
 class QCommandLineParser;
+class LayoutBatchRenderer;
+class LayoutBenchmark;
 
 class Application : public QApplication
 {
@@ -43,6 +45,8 @@ private:
     void checkUpdateResults();
 
     QCommandLineParser* _cmdLine = nullptr;
+    LayoutBatchRenderer* _batchRenderer = nullptr;
+    LayoutBenchmark* _benchmark = nullptr;
     MainWindow* _mainWindow = nullptr;
     Settings* _settings = nullptr;
     QNetworkAccessManager* _network = nullptr;
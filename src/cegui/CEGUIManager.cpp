@@ -1,6 +1,7 @@
 #include "src/cegui/CEGUIManager.h"
 #include "src/cegui/CEGUIProject.h"
 #include "src/cegui/CEGUIUtils.h"
+#include "src/cegui/CEGUIResourcePrefetcher.h"
 #include "src/cegui/QtnPropertyUDim.h"
 #include "src/cegui/QtnPropertyUVector2.h"
 #include "src/cegui/QtnPropertyUVector3.h"
@@ -9,6 +10,7 @@
 #include "src/cegui/QtnPropertyUBox.h"
 #include "src/cegui/QtnPropertyColourRect.h"
 #include "src/ui/CEGUIDebugInfo.h"
+#include "src/ui/CEGUIGraphicsScene.h"
 #include "src/util/DismissableMessage.h"
 #include "src/util/Utils.h"
 #include "src/Application.h"
@@ -22,14 +24,30 @@
 #include "qmessagebox.h"
 #include "qprogressdialog.h"
 #include "qdiriterator.h"
+#include "qfile.h"
+#include "qstandardpaths.h"
 #include "qopenglcontext.h"
 #include "qoffscreensurface.h"
 #include "qopenglframebufferobject.h"
 #include "qopenglfunctions.h"
+#include "qelapsedtimer.h"
+#include "qtimer.h"
+#include "qgraphicsview.h"
+#include "qcryptographichash.h"
+#include "qdebug.h"
+#include <stdexcept>
+#include <limits>
 #include <qopenglfunctions_3_2_core.h>
 #include <qdom.h>
+#include <algorithm>
 #include <qtextstream.h>
 
+// Render target sizes are rounded up to buckets, so that small resizes reuse the same buffer
+static const int FBOSizeBucket = 256;
+static const qint64 FBOReleaseDelayMsec = 5000;
+static const size_t MaxFreeFBOs = 4;
+static const size_t MaxFreeViewportTargets = 8;
+
 // Allows us to register subscribers that want CEGUI log info
 // This prevents writing CEGUI.log into CWD and allow log display inside the app
 class RedirectingCEGUILogger : public CEGUI::Logger
@@ -76,6 +94,9 @@ CEGUIManager::~CEGUIManager()
     {
         logger->unsubscribeAll();
         cleanCEGUIResources();
+        for (auto target : _freeViewportTargets)
+            delete target;
+        _freeViewportTargets.clear();
         if (_isOpenGL3)
             CEGUI::OpenGL3Renderer::destroySystem();
         else
@@ -150,28 +171,27 @@ CEGUIProject* CEGUIManager::createProject(const QString& filePath, bool createRe
 // Opens the project file given in 'path'. Assumes no project is opened at the point this is called.
 // Caller must test if a project is opened and close it accordingly (with a dialog
 // being shown if there are changes to it)
-// Errors aren't indicated by exceptions or return values, dialogs are shown in case of errors.
-void CEGUIManager::loadProject(const QString& filePath)
+// Errors aren't indicated by exceptions, dialogs are shown in case of errors. Returns false if the project
+// wasn't loaded or its resources weren't synchronised with CEGUI.
+bool CEGUIManager::loadProject(const QString& filePath)
 {
     if (isProjectLoaded())
     {
-        QMessageBox::critical(qobject_cast<Application*>(qApp)->getMainWindow(),
-                              "Error when opening project",
-                              "There is another project opened. Close it before opening another one.");
-        return;
+        showErrorMessage("Error when opening project",
+                         "There is another project opened. Close it before opening another one.", true);
+        return false;
     }
 
     currentProject.reset(new CEGUIProject());
     if (!currentProject->loadFromFile(filePath))
     {
-        QMessageBox::critical(qobject_cast<Application*>(qApp)->getMainWindow(),
-                              "Error when opening project",
-                              QString("It seems project at path '%s' doesn't exist or you don't have rights to open it.").arg(filePath));
+        showErrorMessage("Error when opening project",
+                         QString("It seems project at path '%1' doesn't exist or you don't have rights to open it.").arg(filePath), true);
         currentProject.reset();
-        return;
+        return false;
     }
 
-    syncProjectToCEGUIInstance();
+    return syncProjectToCEGUIInstance();
 }
 
 // Closes currently opened project. Assumes the one is opened at the point this is called.
@@ -183,6 +203,7 @@ void CEGUIManager::unloadProject()
     cleanCEGUIResources();
 
     _widgetPreviewCache.clear();
+    _propertySchemas.clear();
 
     currentProject->unload();
     currentProject.reset();
@@ -213,7 +234,7 @@ void CEGUIManager::ensureCEGUIInitialized()
         return;
     }
 
-    if (!glContext->hasExtension("GL_EXT_framebuffer_object"))
+    if (!glContext->hasExtension("GL_EXT_framebuffer_object") && _interactive)
     {
         DismissableMessage::warning(qobject_cast<Application*>(qApp)->getMainWindow(),
                                     "No FBO support!",
@@ -245,7 +266,7 @@ void CEGUIManager::ensureCEGUIInitialized()
     }
     catch (const std::exception& e)
     {
-        QMessageBox::warning(nullptr, "Exception", e.what());
+        showErrorMessage("Exception", e.what());
         return;
     }
 
@@ -290,6 +311,22 @@ void CEGUIManager::ensureCEGUIInitialized()
     initialized = true;
 }
 
+// In a non-interactive (batch) mode errors are written to the log instead of blocking message boxes
+void CEGUIManager::showErrorMessage(const QString& title, const QString& message, bool critical) const
+{
+    if (!_interactive)
+    {
+        qCritical().noquote() << title << ":" << message;
+        return;
+    }
+
+    auto mainWnd = qobject_cast<Application*>(qApp)->getMainWindow();
+    if (critical)
+        QMessageBox::critical(mainWnd, title, message);
+    else
+        QMessageBox::warning(mainWnd, title, message);
+}
+
 bool CEGUIManager::makeOpenGLContextCurrent()
 {
     return glContext ? glContext->makeCurrent(surface) : false;
@@ -300,6 +337,168 @@ void CEGUIManager::doneOpenGLContextCurrent()
     if (glContext) glContext->doneCurrent();
 }
 
+// Returns a buffer of at least the requested size. Callers render into its bottom-left sub-rect.
+QOpenGLFramebufferObject* CEGUIManager::acquireFBO(int width, int height)
+{
+    const int bucketWidth = ((std::max(width, 1) + FBOSizeBucket - 1) / FBOSizeBucket) * FBOSizeBucket;
+    const int bucketHeight = ((std::max(height, 1) + FBOSizeBucket - 1) / FBOSizeBucket) * FBOSizeBucket;
+
+    // Reuse the smallest fitting buffer unless it wastes too much memory
+    auto bestIt = _freeFBOs.end();
+    qint64 bestArea = 2 * static_cast<qint64>(bucketWidth) * bucketHeight + 1;
+    for (auto it = _freeFBOs.begin(); it != _freeFBOs.end(); ++it)
+    {
+        const QSize size = it->fbo->size();
+        const qint64 area = static_cast<qint64>(size.width()) * size.height();
+        if (size.width() >= width && size.height() >= height && area < bestArea)
+        {
+            bestIt = it;
+            bestArea = area;
+        }
+    }
+
+    if (bestIt == _freeFBOs.end())
+        return new QOpenGLFramebufferObject(bucketWidth, bucketHeight);
+
+    QOpenGLFramebufferObject* fbo = bestIt->fbo;
+    _freeFBOs.erase(bestIt);
+    return fbo;
+}
+
+// The buffer is destroyed later if nobody acquires it, e.g. while the resolution is changed interactively.
+// Buffers not intended for reuse are destroyed immediately.
+void CEGUIManager::releaseFBO(QOpenGLFramebufferObject* fbo, bool reuse)
+{
+    if (!fbo) return;
+
+    if (!reuse)
+    {
+        const bool wasCurrent = (glContext && QOpenGLContext::currentContext() == glContext);
+        if (!wasCurrent) makeOpenGLContextCurrent();
+        delete fbo;
+        if (!wasCurrent) doneOpenGLContextCurrent();
+        return;
+    }
+
+    _freeFBOs.push_back({ fbo, QDateTime::currentMSecsSinceEpoch() });
+
+    if (!_renderTargetTrimScheduled)
+    {
+        _renderTargetTrimScheduled = true;
+        QTimer::singleShot(FBOReleaseDelayMsec, [this]() { trimRenderTargetPool(); });
+    }
+}
+
+CEGUI::OpenGLViewportTarget* CEGUIManager::acquireViewportTarget(float width, float height)
+{
+    const CEGUI::Rectf area(0.f, 0.f, width, height);
+
+    if (_freeViewportTargets.empty())
+    {
+        auto renderer = static_cast<CEGUI::OpenGLRendererBase*>(CEGUI::System::getSingleton().getRenderer());
+        return new CEGUI::OpenGLViewportTarget(*renderer, area);
+    }
+
+    auto target = _freeViewportTargets.back();
+    _freeViewportTargets.pop_back();
+    target->setArea(area);
+    return target;
+}
+
+void CEGUIManager::releaseViewportTarget(CEGUI::OpenGLViewportTarget* target)
+{
+    if (!target) return;
+
+    if (_freeViewportTargets.size() < MaxFreeViewportTargets)
+        _freeViewportTargets.push_back(target);
+    else
+        delete target;
+}
+
+// Scenes keep their last rendered frame to present it instantly when shown again, e.g. on switching tabs.
+// When these frames exceed the budget, least recently used ones are dropped, except for visible scenes.
+void CEGUIManager::onOffscreenBufferUsed(CEGUIGraphicsScene* scene, bool acquired)
+{
+    auto it = std::find(_offscreenBufferLRU.begin(), _offscreenBufferLRU.end(), scene);
+    if (it == _offscreenBufferLRU.end())
+        _offscreenBufferLRU.push_front(scene);
+    else if (it != _offscreenBufferLRU.begin())
+        _offscreenBufferLRU.splice(_offscreenBufferLRU.begin(), _offscreenBufferLRU, it);
+
+    // The total size changes only when a new buffer is acquired
+    if (!acquired) return;
+
+    auto&& settings = qobject_cast<Application*>(qApp)->getSettings();
+    const qint64 budget = settings->getEntryValue("cegui/rendering/offscreen_cache_size", 256).toLongLong() * 1024 * 1024;
+
+    qint64 totalSize = 0;
+    for (auto lruScene : _offscreenBufferLRU)
+        if (auto fbo = lruScene->getOffscreenBuffer())
+            totalSize += static_cast<qint64>(fbo->width()) * fbo->height() * 4;
+
+    auto evictIt = _offscreenBufferLRU.end();
+    while (totalSize > budget && evictIt != _offscreenBufferLRU.begin())
+    {
+        CEGUIGraphicsScene* lruScene = *(--evictIt);
+        if (lruScene == scene) continue;
+
+        const auto views = lruScene->views();
+        const bool visible = std::any_of(views.cbegin(), views.cend(), [](const QGraphicsView* view) { return view->isVisible(); });
+        if (visible) continue;
+
+        if (auto fbo = lruScene->getOffscreenBuffer())
+            totalSize -= static_cast<qint64>(fbo->width()) * fbo->height() * 4;
+
+        // Removes the scene from the LRU list. The buffer is destroyed rather than pooled, otherwise
+        // the memory would stay allocated outside of the budget.
+        ++evictIt;
+        lruScene->releaseOffscreenBuffer(false);
+    }
+}
+
+void CEGUIManager::onOffscreenBufferReleased(CEGUIGraphicsScene* scene)
+{
+    _offscreenBufferLRU.remove(scene);
+}
+
+// Destroys free buffers that weren't reused in time and the oldest ones over the limit
+void CEGUIManager::trimRenderTargetPool(bool all)
+{
+    _renderTargetTrimScheduled = false;
+
+    if (_freeFBOs.empty()) return;
+
+    std::sort(_freeFBOs.begin(), _freeFBOs.end(), [](const PooledFBO& a, const PooledFBO& b)
+    {
+        return a.releaseTime > b.releaseTime;
+    });
+
+    const qint64 expirationTime = QDateTime::currentMSecsSinceEpoch() - FBOReleaseDelayMsec;
+    size_t keepCount = 0;
+    if (!all)
+        while (keepCount < _freeFBOs.size() && keepCount < MaxFreeFBOs && _freeFBOs[keepCount].releaseTime > expirationTime)
+            ++keepCount;
+
+    if (keepCount < _freeFBOs.size())
+    {
+        const bool wasCurrent = (glContext && QOpenGLContext::currentContext() == glContext);
+        if (!wasCurrent) makeOpenGLContextCurrent();
+
+        for (size_t i = keepCount; i < _freeFBOs.size(); ++i)
+            delete _freeFBOs[i].fbo;
+        _freeFBOs.resize(keepCount);
+
+        if (!wasCurrent) doneOpenGLContextCurrent();
+    }
+
+    // Check remaining buffers later
+    if (!_freeFBOs.empty())
+    {
+        _renderTargetTrimScheduled = true;
+        QTimer::singleShot(FBOReleaseDelayMsec, [this]() { trimRenderTargetPool(); });
+    }
+}
+
 void CEGUIManager::showDebugInfo()
 {
     if (debugInfo)
@@ -321,18 +520,20 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
 
     if (!currentProject->checkAllDirectories())
     {
-        QMessageBox::warning(mainWnd,
-                             "At least one of project's resource directories is invalid",
-                             "Project's resource directory paths didn't pass the sanity check, please check projects settings.");
+        showErrorMessage("At least one of project's resource directories is invalid",
+                         "Project's resource directory paths didn't pass the sanity check, please check projects settings.");
         return false;
     }
 
     QProgressDialog progress(mainWnd);
     progress.setWindowModality(Qt::WindowModal);
     progress.setWindowTitle("Synchronising embedded CEGUI with the project");
-    progress.setCancelButton(nullptr);
+    progress.setCancelButtonText("Cancel");
     progress.resize(400, 100);
-    progress.show();
+    if (_interactive)
+        progress.show();
+    else
+        progress.setMinimumDuration(std::numeric_limits<int>::max());
 
     ensureCEGUIInitialized();
 
@@ -341,7 +542,7 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
     if (!QDir(absoluteSchemesPath).exists())
     {
         progress.reset();
-        QMessageBox::warning(mainWnd, "Failed to synchronise embedded CEGUI to your project",
+        showErrorMessage("Failed to synchronise embedded CEGUI to your project",
            "Can't list scheme path '" + absoluteSchemesPath + "'\n\n"
            "This means that editing capabilities of CEED will be limited to editing of files "
            "that don't require a project opened (for example: imagesets).");
@@ -357,6 +558,14 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
             schemeFiles.append(schemesIt.fileName());
     }
 
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    // Start reading files in background while we purge old resources and process already read ones
+    CEGUIResourcePrefetcher prefetcher(*currentProject);
+    for (auto& schemeFile : schemeFiles)
+        prefetcher.prefetchScheme(schemeFile);
+
     progress.setMinimum(0);
     progress.setMaximum(2 + 9 * schemeFiles.size());
 
@@ -392,16 +601,46 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
     // We will load resources manually to be able to use the compatibility layer machinery
     CEGUI::SchemeManager::getSingleton().setAutoLoadResources(false);
 
+    struct SyncCancelledException {};
+
     bool result = true;
     try
     {
         auto updateProgress = [&progress](const QString& schemeFile, const QString& message)
         {
+            if (progress.wasCanceled()) throw SyncCancelledException();
             progress.setValue(progress.value() + 1);
             progress.setLabelText(QString("Recreating all schemes... (%1)\n\n%2").arg(schemeFile, message));
             QApplication::instance()->processEvents();
         };
 
+        // Creates a resource from the prefetched data, falls back to loading from file by CEGUI if there is no data.
+        // Reports timings to the CEGUI log. Read time is spent in a worker, wait time is a main thread stall.
+        auto loadResource = [this, &prefetcher](const QString& resourceType, const CEGUI::String& fileName, const CEGUI::String& resourceGroup,
+                const CEGUI::String& defaultResourceGroup, std::function<void(const CEGUI::String&)> createFromString,
+                std::function<void()> createFromFile)
+        {
+            const QString qFileName = CEGUIUtils::stringToQString(fileName);
+            const QString qResourceGroup = CEGUIUtils::stringToQString(resourceGroup.empty() ? defaultResourceGroup : resourceGroup);
+
+            QElapsedTimer timer;
+            timer.start();
+            qint64 readTimeMs = 0;
+            const QByteArray data = prefetcher.takeData(qFileName, qResourceGroup, &readTimeMs);
+            const qint64 waitTimeMs = timer.restart();
+
+            if (data.isEmpty())
+                createFromFile();
+            else
+                createFromString(CEGUIUtils::qStringToString(QString::fromUtf8(data)));
+
+            updateResourceFingerprint(currentProject->getResourceFilePath(qFileName, qResourceGroup), resourceType, data);
+
+            CEGUI::Logger::getSingleton().logEvent(CEGUIUtils::qStringToString(
+                QString("[CEED] Loaded %1 '%2': read %3 ms, waited %4 ms, created %5 ms")
+                    .arg(resourceType, qFileName).arg(readTimeMs).arg(waitTimeMs).arg(timer.elapsed())));
+        };
+
         for (auto& schemeFile : schemeFiles)
         {
             updateProgress(schemeFile, "Parsing the scheme file");
@@ -433,7 +672,12 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
             scheme = CEGUI::SchemeManager::getSingleton().createFromString(nativeData)
             */
 
-            CEGUI::Scheme& scheme = CEGUI::SchemeManager::getSingleton().createFromFile(CEGUIUtils::qStringToString(schemeFile));
+            CEGUI::Scheme* schemePtr = nullptr;
+            const auto schemeFileName = CEGUIUtils::qStringToString(schemeFile);
+            loadResource("scheme", schemeFileName, CEGUI::Scheme::getDefaultResourceGroup(), CEGUI::Scheme::getDefaultResourceGroup(),
+                [&schemePtr](const CEGUI::String& source) { schemePtr = &CEGUI::SchemeManager::getSingleton().createFromString(source); },
+                [&schemePtr, &schemeFileName]() { schemePtr = &CEGUI::SchemeManager::getSingleton().createFromFile(schemeFileName); });
+            CEGUI::Scheme& scheme = *schemePtr;
 
             // NOTE: This is very CEGUI implementation specific unfortunately!
             //       However I am not really sure how to do this any better.
@@ -470,7 +714,10 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
                 CEGUI::ImageManager::getSingleton().loadImagesetFromString(imagesetNativeData)
                 */
 
-                CEGUI::ImageManager::getSingleton().loadImageset(loadableUIElement.filename, loadableUIElement.resourceGroup);
+                loadResource("imageset", loadableUIElement.filename, loadableUIElement.resourceGroup,
+                    CEGUI::ImageManager::getImagesetDefaultResourceGroup(),
+                    [](const CEGUI::String& source) { CEGUI::ImageManager::getSingleton().loadImagesetFromString(source); },
+                    [&loadableUIElement]() { CEGUI::ImageManager::getSingleton().loadImageset(loadableUIElement.filename, loadableUIElement.resourceGroup); });
 
                 ++xmlImagesetIterator;
             }
@@ -512,7 +759,9 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
                 CEGUI::FontManager::getSingleton().createFromString(fontNativeData)
                 */
 
-                CEGUI::FontManager::getSingleton().createFromFile(loadableUIElement.filename, loadableUIElement.resourceGroup);
+                loadResource("font", loadableUIElement.filename, loadableUIElement.resourceGroup, CEGUI::Font::getDefaultResourceGroup(),
+                    [](const CEGUI::String& source) { CEGUI::FontManager::getSingleton().createFromString(source); },
+                    [&loadableUIElement]() { CEGUI::FontManager::getSingleton().createFromFile(loadableUIElement.filename, loadableUIElement.resourceGroup); });
 
                 ++fontIterator;
             }
@@ -549,7 +798,10 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
                 CEGUI::WidgetLookManager::getSingleton().parseLookNFeelSpecificationFromString(looknfeelNativeData)
                 */
 
-                CEGUI::WidgetLookManager::getSingleton().parseLookNFeelSpecificationFromFile(loadableUIElement.filename, loadableUIElement.resourceGroup);
+                loadResource("looknfeel", loadableUIElement.filename, loadableUIElement.resourceGroup,
+                    CEGUI::WidgetLookManager::getDefaultResourceGroup(),
+                    [](const CEGUI::String& source) { CEGUI::WidgetLookManager::getSingleton().parseLookNFeelSpecificationFromString(source); },
+                    [&loadableUIElement]() { CEGUI::WidgetLookManager::getSingleton().parseLookNFeelSpecificationFromFile(loadableUIElement.filename, loadableUIElement.resourceGroup); });
 
                 ++looknfeelIterator;
             }
@@ -564,10 +816,17 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
             scheme.loadFalagardMappings();
         }
     }
+    catch (const SyncCancelledException&)
+    {
+        prefetcher.cancel();
+        cleanCEGUIResources();
+        result = false;
+    }
     catch (const std::exception& e)
     {
+        prefetcher.cancel();
         cleanCEGUIResources();
-        QMessageBox::warning(mainWnd, "Failed to synchronise embedded CEGUI to your project",
+        showErrorMessage("Failed to synchronise embedded CEGUI to your project",
             QString("An attempt was made to load resources related to the project being opened, "
             "for some reason the loading didn't succeed so all resources were destroyed! "
             "The most likely reason is that the resource directories are wrong, this can "
@@ -580,8 +839,13 @@ bool CEGUIManager::syncProjectToCEGUIInstance()
     // Put SchemeManager into the default state again
     CEGUI::SchemeManager::getSingleton().setAutoLoadResources(true);
 
+    CEGUI::Logger::getSingleton().logEvent(CEGUIUtils::qStringToString(
+        QString("[CEED] Project synchronisation %1 in %2 ms").arg(result ? "finished" : "aborted").arg(totalTimer.elapsed())));
+
     doneOpenGLContextCurrent();
 
+    if (result) updatePreviewCacheDir();
+
     progress.reset();
     QApplication::instance()->processEvents();
 
@@ -612,7 +876,249 @@ void CEGUIManager::cleanCEGUIResources()
     CEGUI::System::getSingleton().addStandardWindowFactories();
     CEGUI::System::getSingleton().getRenderer()->destroyAllTextures();
 
+    delete _previewAtlasFBO;
+    _previewAtlasFBO = nullptr;
+
+    trimRenderTargetPool(true);
+
     doneOpenGLContextCurrent();
+
+    _resourceFingerprints.clear();
+    _changedResources.clear();
+    _widgetPreviewCache.clear();
+    _propertySchemas.clear();
+    _previewCacheDir.clear();
+}
+
+// Remembers the state of the resource file just loaded to CEGUI, see detectChangedResources
+void CEGUIManager::updateResourceFingerprint(const QString& filePath, const QString& resourceType, const QByteArray& data)
+{
+    if (filePath.isEmpty()) return;
+
+    QByteArray fileData = data;
+    if (fileData.isEmpty())
+    {
+        QFile file(filePath);
+        if (file.open(QIODevice::ReadOnly))
+            fileData = file.readAll();
+    }
+
+    QFileInfo info(filePath);
+    auto& fingerprint = _resourceFingerprints[filePath];
+    fingerprint.type = resourceType;
+    fingerprint.modified = info.lastModified();
+    fingerprint.size = info.size();
+    fingerprint.hash = QCryptographicHash::hash(fileData, QCryptographicHash::Sha1);
+
+    // Texture changes require reloading of the imageset. Images are not hashed to keep synchronisation fast.
+    if (resourceType == "imageset")
+    {
+        QDomDocument doc;
+        if (!doc.setContent(fileData)) return;
+
+        const auto root = doc.documentElement();
+        const QString imageFile = root.attribute("imagefile");
+        if (imageFile.isEmpty()) return;
+
+        const QString resourceGroup = root.attribute("resourceGroup");
+        const QString imagePath = currentProject->getResourceFilePath(imageFile, resourceGroup.isEmpty() ? "imagesets" : resourceGroup);
+        if (imagePath.isEmpty()) return;
+
+        QFileInfo imageInfo(imagePath);
+        auto& imageFingerprint = _resourceFingerprints[imagePath];
+        imageFingerprint.type = "image";
+        imageFingerprint.owner = filePath;
+        imageFingerprint.modified = imageInfo.lastModified();
+        imageFingerprint.size = imageInfo.size();
+    }
+}
+
+// Compares project resource files with their state at the moment of loading. Changes in imagesets and looknfeels
+// can be applied by reloadChangedResources, anything else (schemes, fonts, added or removed files) requires
+// a full synchronisation.
+CEGUIManager::ResourceChanges CEGUIManager::detectChangedResources()
+{
+    _changedResources.clear();
+
+    if (!currentProject || !initialized || _resourceFingerprints.empty()) return ResourceChanges::Full;
+
+    // Added or removed scheme files
+    int schemeCount = 0;
+    QDirIterator schemesIt(currentProject->getAbsolutePathOf(currentProject->schemesPath));
+    while (schemesIt.hasNext())
+    {
+        schemesIt.next();
+        QFileInfo info = schemesIt.fileInfo();
+        if (info.isDir() || info.suffix() != "scheme") continue;
+
+        auto it = _resourceFingerprints.find(info.absoluteFilePath());
+        if (it == _resourceFingerprints.end() || it->second.type != "scheme") return ResourceChanges::Full;
+
+        ++schemeCount;
+    }
+
+    for (auto& pair : _resourceFingerprints)
+    {
+        if (pair.second.type == "scheme") --schemeCount;
+
+        QFileInfo info(pair.first);
+        if (!info.exists()) return ResourceChanges::Full;
+
+        auto& fingerprint = pair.second;
+        if (info.lastModified() == fingerprint.modified && info.size() == fingerprint.size) continue;
+
+        if (fingerprint.type == "image")
+        {
+            _changedResources.insert(fingerprint.owner);
+            continue;
+        }
+
+        // Timestamp may change without content changes, e.g. after a VCS checkout
+        QFile file(pair.first);
+        if (!file.open(QIODevice::ReadOnly)) return ResourceChanges::Full;
+        const auto hash = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+        if (hash == fingerprint.hash)
+        {
+            fingerprint.modified = info.lastModified();
+            fingerprint.size = info.size();
+            continue;
+        }
+
+        if (fingerprint.type != "imageset" && fingerprint.type != "looknfeel") return ResourceChanges::Full;
+
+        _changedResources.insert(pair.first);
+    }
+
+    if (schemeCount != 0) return ResourceChanges::Full;
+
+    return _changedResources.empty() ? ResourceChanges::None : ResourceChanges::Partial;
+}
+
+// Reloads resources found by detectChangedResources. Caller must ensure that no CEGUI windows exist at this point,
+// because they may reference replaced looks and images. Falls back to the full synchronisation on failure.
+bool CEGUIManager::reloadChangedResources()
+{
+    if (_changedResources.empty()) return true;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    makeOpenGLContextCurrent();
+
+    // Released windows must not outlive looks they were created with
+    CEGUI::WindowManager::getSingleton().cleanDeadPool();
+
+    bool result = true;
+    try
+    {
+        auto readFile = [](const QString& filePath)
+        {
+            QFile file(filePath);
+            if (!file.open(QIODevice::ReadOnly))
+                throw std::runtime_error(("Can't read file " + filePath).toStdString());
+            return file.readAll();
+        };
+
+        bool imagesetChanged = false;
+        std::set<QString> changedLooks;
+        for (const QString& filePath : _changedResources)
+        {
+            if (_resourceFingerprints[filePath].type == "looknfeel")
+            {
+                changedLooks.insert(filePath);
+                continue;
+            }
+
+            const QByteArray data = readFile(filePath);
+
+            QDomDocument doc;
+            if (!doc.setContent(data))
+                throw std::runtime_error(("Can't parse imageset " + filePath).toStdString());
+
+            // Old texture is destroyed along with images
+            const auto imagesetName = CEGUIUtils::qStringToString(doc.documentElement().attribute("name"));
+            CEGUI::ImageManager::getSingleton().destroyImageCollection(imagesetName);
+            CEGUI::ImageManager::getSingleton().loadImagesetFromString(CEGUIUtils::qStringToString(QString::fromUtf8(data)));
+
+            updateResourceFingerprint(filePath, "imageset", data);
+            imagesetChanged = true;
+        }
+
+        // Looks hold pointers to images, so when any imageset is reloaded all looks must be reparsed
+        for (auto& pair : _resourceFingerprints)
+        {
+            if (pair.second.type != "looknfeel") continue;
+            if (!imagesetChanged && changedLooks.find(pair.first) == changedLooks.end()) continue;
+
+            const QByteArray data = readFile(pair.first);
+            CEGUI::WidgetLookManager::getSingleton().parseLookNFeelSpecificationFromString(CEGUIUtils::qStringToString(QString::fromUtf8(data)));
+            updateResourceFingerprint(pair.first, "looknfeel", data);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        CEGUI::Logger::getSingleton().logEvent(CEGUIUtils::qStringToString(
+            QString("[CEED] Incremental resource reload failed, performing full synchronisation: %1").arg(e.what())),
+            CEGUI::LoggingLevel::Error);
+        result = false;
+    }
+
+    doneOpenGLContextCurrent();
+
+    // Previews may be affected by any look or image. Looks also define property defaults and help.
+    _widgetPreviewCache.clear();
+    _propertySchemas.clear();
+
+    if (!result) return syncProjectToCEGUIInstance();
+
+    CEGUI::Logger::getSingleton().logEvent(CEGUIUtils::qStringToString(
+        QString("[CEED] Reloaded %1 changed resources in %2 ms").arg(_changedResources.size()).arg(timer.elapsed())));
+
+    _changedResources.clear();
+    updatePreviewCacheDir();
+    return true;
+}
+
+// Widget previews are stored on disk per project. Directory name is a hash of all loaded resources,
+// so any change in looknfeels, imagesets or fonts leads to a new directory and the old one is purged.
+void CEGUIManager::updatePreviewCacheDir()
+{
+    _previewCacheDir.clear();
+
+    if (!currentProject || currentProject->uuid.isNull() || _resourceFingerprints.empty()) return;
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(CEGUIProject::EditorEmbeddedCEGUIVersion.toUtf8());
+    for (const auto& pair : _resourceFingerprints)
+    {
+        hash.addData(currentProject->getRelativePathOf(pair.first).toUtf8());
+        hash.addData(pair.second.hash);
+        hash.addData(QByteArray::number(pair.second.size));
+        if (pair.second.hash.isEmpty())
+            hash.addData(QByteArray::number(pair.second.modified.toMSecsSinceEpoch()));
+    }
+
+    const QString inputsHash = QString::fromLatin1(hash.result().toHex());
+
+    QDir projectCacheDir(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath(
+                             "widget_previews/" + currentProject->uuid.toString(QUuid::StringFormat::WithoutBraces)));
+
+    // Previews of outdated resources will never be used again
+    for (const QString& dirName : projectCacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        if (dirName != inputsHash)
+            QDir(projectCacheDir.filePath(dirName)).removeRecursively();
+
+    if (!projectCacheDir.mkpath(inputsHash)) return;
+
+    _previewCacheDir = projectCacheDir.filePath(inputsHash);
+}
+
+QString CEGUIManager::getPreviewCacheFilePath(const QString& widgetType, int previewWidth, int previewHeight) const
+{
+    if (_previewCacheDir.isEmpty()) return QString();
+
+    // Skin becomes a subdirectory
+    return QDir(_previewCacheDir).filePath(QString("%1_%2x%3.png").arg(widgetType).arg(previewWidth).arg(previewHeight));
 }
 
 // Retrieves names of skins that are available from the set of schemes that were loaded.
@@ -902,8 +1408,51 @@ const QImage* CEGUIManager::getWidgetPreviewImage(const QString& widgetType, int
     // No other skinless widgets are currently supported
     if (widgetType.indexOf('/') < 0) return nullptr;
 
-    ensureCEGUIInitialized();
+    // Try a preview rendered in one of previous sessions
+    if (loadCachedWidgetPreview(widgetType, previewWidth, previewHeight))
+        return &_widgetPreviewCache[widgetType];
+
+    const QString error = renderWidgetPreviews({ widgetType }, previewWidth, previewHeight);
+    if (!error.isEmpty())
+        throw error;
+
+    it = _widgetPreviewCache.find(widgetType);
+    return (it != _widgetPreviewCache.cend()) ? &it->second : nullptr;
+}
+
+// Renders previews of all given widget types not cached yet in one pass, e.g. for a whole skin at once
+void CEGUIManager::prepareWidgetPreviews(const QStringList& widgetTypes, int previewWidth, int previewHeight)
+{
+    QStringList typesToRender;
+    for (const QString& widgetType : widgetTypes)
+    {
+        // Skinless widgets have no CEGUI rendering
+        if (widgetType.indexOf('/') < 0) continue;
+        if (_widgetPreviewCache.find(widgetType) != _widgetPreviewCache.cend()) continue;
+        if (loadCachedWidgetPreview(widgetType, previewWidth, previewHeight)) continue;
 
+        typesToRender.push_back(widgetType);
+    }
+
+    // Failed widgets will report errors when requested individually
+    if (!typesToRender.empty())
+        renderWidgetPreviews(typesToRender, previewWidth, previewHeight);
+}
+
+bool CEGUIManager::loadCachedWidgetPreview(const QString& widgetType, int previewWidth, int previewHeight)
+{
+    const QString cacheFilePath = getPreviewCacheFilePath(widgetType, previewWidth, previewHeight);
+    if (cacheFilePath.isEmpty()) return false;
+
+    QImage result;
+    if (!result.load(cacheFilePath, "PNG")) return false;
+
+    _widgetPreviewCache.emplace(widgetType, std::move(result));
+    return true;
+}
+
+CEGUI::Window* CEGUIManager::createPreviewWidget(const QString& widgetType, int previewWidth, int previewHeight)
+{
     auto widgetInstance = CEGUI::WindowManager::getSingleton().createWindow(CEGUIUtils::qStringToString(widgetType), "preview");
     widgetInstance->setVisible(true);
     widgetInstance->setUsingAutoRenderingSurface(false); // Avoid unnecessary RT creation
@@ -958,55 +1507,197 @@ const QImage* CEGUIManager::getWidgetPreviewImage(const QString& widgetType, int
     // Fake update to ensure everything is set
     widgetInstance->update(1.f);
 
-    // Size could change, use an actual one
-    const auto size = widgetInstance->calculatePixelSize();
+    return widgetInstance;
+}
 
-    //???allocate previews once?
-    // TODO: renderer->get/createViewportTarget!
-    auto renderer = static_cast<CEGUI::OpenGLRendererBase*>(CEGUI::System::getSingleton().getRenderer());
-    auto renderTarget = new CEGUI::OpenGLViewportTarget(*renderer, CEGUI::Rectf(0.f, 0.f, size.d_width, size.d_height));
-    auto renderingSurface = new CEGUI::RenderingSurface(*renderTarget);
-    widgetInstance->setRenderingSurface(renderingSurface);
+// Renders previews into a shared atlas FBO. Widgets are packed into shelves, all of them are drawn
+// in a single rendering pass and read back at once. Returns the first error occured.
+QString CEGUIManager::renderWidgetPreviews(const QStringList& widgetTypes, int previewWidth, int previewHeight)
+{
+    ensureCEGUIInitialized();
 
-    makeOpenGLContextCurrent();
+    struct PreviewItem
+    {
+        QString widgetType;
+        CEGUI::Window* widget = nullptr;
+        QRect rect; // In the atlas image, top-left origin
+    };
 
-    // Create FBO of an actual object size
-    auto temporaryFBO = new QOpenGLFramebufferObject(static_cast<int>(size.d_width), static_cast<int>(size.d_height));
-    temporaryFBO->bind();
+    QString error;
+    std::vector<PreviewItem> items;
+    for (const QString& widgetType : widgetTypes)
+    {
+        try
+        {
+            PreviewItem item;
+            item.widgetType = widgetType;
+            item.widget = createPreviewWidget(widgetType, previewWidth, previewHeight);
+
+            // Size could change, use an actual one
+            const auto size = item.widget->calculatePixelSize();
+            item.rect.setSize(QSize(std::max(1, static_cast<int>(size.d_width)), std::max(1, static_cast<int>(size.d_height))));
+            items.push_back(std::move(item));
+        }
+        catch (const std::exception& e)
+        {
+            if (error.isEmpty()) error = e.what();
+        }
+    }
 
-    glContext->functions()->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glContext->functions()->glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    if (items.empty()) return error;
 
-    renderer->beginRendering();
+    makeOpenGLContextCurrent();
 
-    QString error;
-    try
+    GLint maxTextureSize = 4096;
+    glContext->functions()->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    const int maxAtlasSize = std::min(4096, static_cast<int>(maxTextureSize));
+
+    // Shelf packing works best when sorted by height
+    std::sort(items.begin(), items.end(), [](const PreviewItem& a, const PreviewItem& b)
     {
-        widgetInstance->draw();
-    }
-    catch (const std::exception& e)
+        return a.rect.height() > b.rect.height();
+    });
+
+    int atlasWidth = 1024;
+    for (const auto& item : items)
+        atlasWidth = std::max(atlasWidth, item.rect.width());
+    atlasWidth = std::min(atlasWidth, maxAtlasSize);
+
+    auto renderer = static_cast<CEGUI::OpenGLRendererBase*>(CEGUI::System::getSingleton().getRenderer());
+
+    // Some widgets draw slightly outside of their area
+    const int padding = 2;
+
+    // Widgets are rendered in a dedicated GUI context under an atlas sized root. Parentless widgets would be
+    // clipped by the global display size, and changing it rescales fonts and relayouts all other contexts.
+    CEGUI::Window* previewRoot = CEGUI::WindowManager::getSingleton().createWindow("DefaultWindow", "WidgetPreviewRoot");
+
+    size_t batchStart = 0;
+    while (batchStart < items.size())
     {
-        error = e.what();
-    }
+        // Pack as many widgets as fit into the atlas
+        int x = 0;
+        int y = 0;
+        int shelfHeight = 0;
+        size_t batchEnd = batchStart;
+        for (; batchEnd < items.size(); ++batchEnd)
+        {
+            QRect& rect = items[batchEnd].rect;
+            if (x > 0 && x + rect.width() > atlasWidth)
+            {
+                x = 0;
+                y += shelfHeight + padding;
+                shelfHeight = 0;
+            }
 
-    renderer->endRendering();
-    temporaryFBO->release();
+            // Oversized widgets are clipped, they are rendered one per atlas
+            if (y > 0 && y + rect.height() > maxAtlasSize) break;
 
-    QImage result = temporaryFBO->toImage();
+            rect.moveTo(x, y);
+            x += rect.width() + padding;
+            shelfHeight = std::max(shelfHeight, rect.height());
+        }
 
-    delete temporaryFBO;
-    CEGUI::WindowManager::getSingleton().destroyWindow(widgetInstance);
-    delete renderingSurface;
-    delete renderTarget;
+        const QSize atlasSize(atlasWidth, std::min(y + shelfHeight, maxAtlasSize));
 
-    doneOpenGLContextCurrent();
+        // Atlas is reused between calls, reallocate only when it is not big enough
+        if (!_previewAtlasFBO || _previewAtlasFBO->width() < atlasSize.width() || _previewAtlasFBO->height() < atlasSize.height())
+        {
+            QSize allocSize = atlasSize;
+            if (_previewAtlasFBO) allocSize = allocSize.expandedTo(_previewAtlasFBO->size());
+            delete _previewAtlasFBO;
+            _previewAtlasFBO = new QOpenGLFramebufferObject(allocSize);
+        }
 
-    if (!error.isEmpty())
-        throw error;
+        _previewAtlasFBO->bind();
+
+        glContext->functions()->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glContext->functions()->glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        renderer->beginRendering();
+
+        // Widgets are placed by their positions rather than by viewports. CEGUI calculates scissor
+        // rects relative to the viewport origin so the viewport must start at 0,0.
+        // TODO: renderer->get/createViewportTarget!
+        const QSize fboSize = _previewAtlasFBO->size();
+        CEGUI::OpenGLViewportTarget renderTarget(*renderer,
+            CEGUI::Rectf(0.f, 0.f, static_cast<float>(fboSize.width()), static_cast<float>(fboSize.height())));
+        CEGUI::GUIContext& previewContext = CEGUI::System::getSingleton().createGUIContext(renderTarget);
+        previewRoot->setSize(CEGUI::USize(CEGUI::UDim(0.f, static_cast<float>(fboSize.width())),
+                                          CEGUI::UDim(0.f, static_cast<float>(fboSize.height()))));
+        previewContext.setRootWindow(previewRoot);
+
+        std::vector<QString> errors(batchEnd - batchStart);
+        for (size_t i = batchStart; i < batchEnd; ++i)
+        {
+            auto& item = items[i];
+            item.widget->setPosition(CEGUI::UVector2(CEGUI::UDim(0.f, static_cast<float>(item.rect.left())),
+                                                     CEGUI::UDim(0.f, static_cast<float>(item.rect.top()))));
+            previewRoot->addChild(item.widget);
+        }
+
+        for (size_t i = batchStart; i < batchEnd; ++i)
+        {
+            try
+            {
+                items[i].widget->draw();
+            }
+            catch (const std::exception& e)
+            {
+                errors[i - batchStart] = e.what();
+            }
+        }
+
+        for (size_t i = batchStart; i < batchEnd; ++i)
+            previewRoot->removeChild(items[i].widget);
+        previewContext.setRootWindow(nullptr);
+        CEGUI::System::getSingleton().destroyGUIContext(previewContext);
 
-    Utils::fillTransparencyWithChecker(result);
+        renderer->endRendering();
+        _previewAtlasFBO->release();
 
-    return &_widgetPreviewCache.emplace(widgetType, std::move(result)).first->second;
+        // A single readback for the whole batch
+        const QImage atlas = _previewAtlasFBO->toImage();
+
+        for (size_t i = batchStart; i < batchEnd; ++i)
+        {
+            auto& item = items[i];
+            const QString& itemError = errors[i - batchStart];
+            if (!itemError.isEmpty())
+            {
+                if (error.isEmpty()) error = itemError;
+                continue;
+            }
+
+            QImage result = atlas.copy(item.rect);
+            Utils::fillTransparencyWithChecker(result);
+
+            const QString cacheFilePath = getPreviewCacheFilePath(item.widgetType, previewWidth, previewHeight);
+            if (!cacheFilePath.isEmpty() && QDir().mkpath(QFileInfo(cacheFilePath).path()))
+                result.save(cacheFilePath, "PNG");
+
+            _widgetPreviewCache.emplace(item.widgetType, std::move(result));
+        }
+
+        batchStart = batchEnd;
+    }
+
+    for (auto& item : items)
+        CEGUI::WindowManager::getSingleton().destroyWindow(item.widget);
+    CEGUI::WindowManager::getSingleton().destroyWindow(previewRoot);
+
+    doneOpenGLContextCurrent();
+
+    return error;
+}
+
+// Falagard widgets of the same type may differ in look'n'feel and renderer, which add their own properties and defaults
+CEGUIManager::PropertySchema& CEGUIManager::getPropertySchema(const CEGUI::Window& widget)
+{
+    const QString key = CEGUIUtils::stringToQString(widget.getType()) + '|' +
+            CEGUIUtils::stringToQString(widget.getLookNFeel()) + '|' +
+            CEGUIUtils::stringToQString(widget.getWindowRendererName());
+    return _propertySchemas[key];
 }
 
 const QtnEnumInfo& CEGUIManager::enumHorizontalAlignment()
@@ -2,8 +2,14 @@
 #define CEGUIManager_H
 #include "qstring.h"
 #include "qimage.h"
+#include "qdatetime.h"
 #include <memory>
+#include <set>
+#include <vector>
+#include <list>
 #include <functional>
+#include <unordered_map>
+#include "src/QtStdHash.h"
 #include <CEGUI/views/StandardItemModel.h>
 
 // A singleton CEGUI manager class controls the loaded project and encapsulates a running CEGUI instance.
@@ -15,8 +21,15 @@ class CEGUIProject;
 class QtnEnumInfo;
 class QOpenGLContext;
 class QOffscreenSurface;
+class QOpenGLFramebufferObject;
 class RedirectingCEGUILogger;
 class CEGUIDebugInfo;
+class CEGUIGraphicsScene;
+
+namespace CEGUI
+{
+    class OpenGLViewportTarget;
+}
 
 class CEGUIManager
 {
@@ -38,7 +51,7 @@ public:
     }
 
     CEGUIProject* createProject(const QString& filePath, bool createResourceDirs);
-    void loadProject(const QString& filePath);
+    bool loadProject(const QString& filePath);
     void unloadProject();
     bool isProjectLoaded() const { return currentProject != nullptr; }
     CEGUIProject* getCurrentProject() const { return currentProject.get(); }
@@ -49,14 +62,48 @@ public:
     QStringList getAvailableImages() const;
     void getAvailableWidgetsBySkin(std::map<QString, QStringList>& out) const;
     const QImage* getWidgetPreviewImage(const QString& widgetType, int previewWidth = 0, int previewHeight = 0);
+    void prepareWidgetPreviews(const QStringList& widgetTypes, int previewWidth = 0, int previewHeight = 0);
+
+    enum class ResourceChanges
+    {
+        None,
+        Partial,
+        Full
+    };
 
     bool syncProjectToCEGUIInstance();
+    ResourceChanges detectChangedResources();
+    bool reloadChangedResources();
     void ensureCEGUIInitialized();
     bool makeOpenGLContextCurrent();
     void doneOpenGLContextCurrent();
     void showDebugInfo();
 
+    // Render targets shared by all CEGUI scenes. FBOs must be acquired with the OpenGL context current.
+    QOpenGLFramebufferObject* acquireFBO(int width, int height);
+    void releaseFBO(QOpenGLFramebufferObject* fbo, bool reuse = true);
+    CEGUI::OpenGLViewportTarget* acquireViewportTarget(float width, float height);
+    void releaseViewportTarget(CEGUI::OpenGLViewportTarget* target);
+    void onOffscreenBufferUsed(CEGUIGraphicsScene* scene, bool acquired);
+    void onOffscreenBufferReleased(CEGUIGraphicsScene* scene);
+
+    // Non-interactive mode is used for command line batch processing, no dialogs are shown there
+    void setInteractive(bool interactive) { _interactive = interactive; }
+    bool isInteractive() const { return _interactive; }
+
     // Property framework support
+
+    // Widget type specific property data, shared between property sets of all widgets of that type, look and renderer
+    struct PropertySchemaEntry
+    {
+        QString category;
+        QString description;
+        CEGUI::String dataType;
+        CEGUI::String defaultValue;
+    };
+    using PropertySchema = std::unordered_map<QString, PropertySchemaEntry>; // Property name -> entry
+
+    PropertySchema& getPropertySchema(const CEGUI::Window& widget);
     const QtnEnumInfo& enumHorizontalAlignment();
     const QtnEnumInfo& enumVerticalAlignment();
     const QtnEnumInfo& enumAspectMode();
@@ -78,17 +125,50 @@ public:
 protected:
 
     void cleanCEGUIResources();
+    void trimRenderTargetPool(bool all = false);
+    void showErrorMessage(const QString& title, const QString& message, bool critical = false) const;
     void initializePreviewWidgetSpecific(CEGUI::Window* widgetInstance, const QString& widgetType);
+    CEGUI::Window* createPreviewWidget(const QString& widgetType, int previewWidth, int previewHeight);
+    QString renderWidgetPreviews(const QStringList& widgetTypes, int previewWidth, int previewHeight);
+    bool loadCachedWidgetPreview(const QString& widgetType, int previewWidth, int previewHeight);
+    void updateResourceFingerprint(const QString& filePath, const QString& resourceType, const QByteArray& data);
+    void updatePreviewCacheDir();
+    QString getPreviewCacheFilePath(const QString& widgetType, int previewWidth, int previewHeight) const;
+
+    struct ResourceFingerprint
+    {
+        QString type;
+        QString owner; // Imageset of the image
+        QDateTime modified;
+        qint64 size = 0;
+        QByteArray hash;
+    };
 
     QOpenGLContext* glContext = nullptr;
     QOffscreenSurface* surface = nullptr;
     RedirectingCEGUILogger* logger = nullptr;
     CEGUIDebugInfo* debugInfo = nullptr;
 
-    // TODO: invalidate cached previews when reload (e.g. edit) imagesets, lnfs and schemes
     std::map<QString, QImage> _widgetPreviewCache;
+    std::unordered_map<QString, PropertySchema> _propertySchemas; // Widget type, look'n'feel and window renderer -> schema
+    QString _previewCacheDir; // Persistent preview storage for the current state of project resources
+    QOpenGLFramebufferObject* _previewAtlasFBO = nullptr;
+
+    struct PooledFBO
+    {
+        QOpenGLFramebufferObject* fbo = nullptr;
+        qint64 releaseTime = 0;
+    };
+
+    std::vector<PooledFBO> _freeFBOs; // Released buffers, destroyed if not reused for a while
+    std::vector<CEGUI::OpenGLViewportTarget*> _freeViewportTargets;
+    bool _renderTargetTrimScheduled = false;
+    std::list<CEGUIGraphicsScene*> _offscreenBufferLRU; // Scenes keeping their last frame, most recently used first
     CEGUI::StandardItemModel _listItemModel;
 
+    std::map<QString, ResourceFingerprint> _resourceFingerprints; // Absolute file path -> state when loaded
+    std::set<QString> _changedResources;
+
     QtnEnumInfo* _enumHorizontalAlignment = nullptr;
     QtnEnumInfo* _enumVerticalAlignment = nullptr;
     QtnEnumInfo* _enumAspectMode = nullptr;
@@ -110,6 +190,7 @@ protected:
     std::unique_ptr<CEGUIProject> currentProject;
     bool initialized = false;
     bool _isOpenGL3 = false;
+    bool _interactive = true;
 };
 
 #endif // CEGUIManager_H
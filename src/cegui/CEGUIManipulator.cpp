@@ -17,6 +17,8 @@
 #include <qgraphicsscene.h>
 #include <qpainter.h>
 #include <qmessagebox.h>
+#include <qtimer.h>
+#include <set>
 #include <CEGUI/widgets/TabControl.h>
 #include <CEGUI/widgets/ScrollablePane.h>
 #include <CEGUI/widgets/ScrolledContainer.h>
@@ -36,18 +38,21 @@
 #include "QtnProperty/PropertyUInt64.h"
 #include "QtnProperty/Delegates/Core/PropertyDelegateQString.h"
 
+// Most recently used first. Selected manipulators are never evicted, so the list may exceed the limit.
+static std::list<CEGUIManipulator*> PropertySetLRU;
+static const size_t MaxCachedPropertySets = 32;
+static bool PropertySetEvictionScheduled = false;
+
 CEGUIManipulator::CEGUIManipulator(QGraphicsItem* parent, CEGUI::Window* widget)
     : ResizableRectItem(parent)
     , _widget(widget)
 {
     setFlags(ItemIsFocusable | ItemIsSelectable | ItemIsMovable | ItemSendsGeometryChanges);
-
-    createPropertySet();
 }
 
 CEGUIManipulator::~CEGUIManipulator()
 {
-    delete _propertySet;
+    destroyPropertySet();
 }
 
 void CEGUIManipulator::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
@@ -59,53 +64,33 @@ void CEGUIManipulator::paint(QPainter* painter, const QStyleOptionGraphicsItem*
         // NOTE: This is just an option because it's very performance intensive, most people editing big layouts will
         //       want this disabled. But it makes editing nicer and fancier :-)
 
-        // We are drawing the outlines after CEGUI has already been rendered so he have to clip overlapping parts
-        // we basically query all items colliding with ourselves and if that's a manipulator and is over us we subtract
-        // that from the clipped path.
-        QPainterPath clipPath;
-        clipPath.addRect(QRectF(-scenePos().x(), -scenePos().y(), scene()->sceneRect().width(), scene()->sceneRect().height()));
-
-        // FIXME: I used self.collidingItems() but that seems way way slower than just going over everything on the scene
-        //        in reality we need siblings of ancestors recursively up to the top
-        //
-        //        this just begs for optimisation in the future
-        auto collidingItems = scene()->items();
-        for (QGraphicsItem* item : collidingItems)
-        {
-            if (!item->isVisible() || item == this) continue;
+        // We are drawing the outlines after CEGUI has already been rendered so he have to clip overlapping parts,
+        // i.e. subtract manipulators stacked above us from the clipped path.
+        painter->setClipPath(getOverlapClipPath().translated(-scenePos()));
+    }
 
-            CEGUIManipulator* manipulator = dynamic_cast<CEGUIManipulator*>(item);
-            if (!manipulator) continue;
+    impl_paint(painter, option, widget);
 
-            // Check if the item is above us
-            // FIXME: nasty nasty way to do this
-            bool isAbove = false;
-            for (QGraphicsItem* itm : scene()->items())
-            {
-                if (itm == this)
-                {
-                    isAbove = true;
-                    break;
-                }
-                else if (itm == item) break;
-            }
+    painter->restore();
+}
 
-            if (isAbove)
-            {
-                QPainterPath boundingClipPath;
-                boundingClipPath.addRect(item->boundingRect());
-                clipPath = clipPath.subtracted(boundingClipPath.translated(item->scenePos() - scenePos()));
-            }
-        }
+// Default implementation goes over the whole scene, derived classes may want to cache it
+QPainterPath CEGUIManipulator::getOverlapClipPath() const
+{
+    QPainterPath clipPath;
+    clipPath.addRect(scene()->sceneRect());
 
-        // We clip using stencil buffers to prevent overlapping outlines appearing
-        // FIXME: This could potentially get very slow for huge layouts
-        painter->setClipPath(clipPath);
+    // Items are returned in descending stacking order, so everything before us is above us
+    QPainterPath abovePath;
+    abovePath.setFillRule(Qt::WindingFill);
+    for (QGraphicsItem* item : scene()->items())
+    {
+        if (item == this) break;
+        if (item->isVisible() && dynamic_cast<CEGUIManipulator*>(item))
+            abovePath.addRect(item->sceneBoundingRect());
     }
 
-    impl_paint(painter, option, widget);
-
-    painter->restore();
+    return abovePath.isEmpty() ? clipPath : clipPath.subtracted(abovePath);
 }
 
 void CEGUIManipulator::impl_paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
@@ -506,26 +491,21 @@ void CEGUIManipulator::notifyResizeFinished(QPointF newPos, QSizeF newSize)
 {
     ResizableRectItem::notifyResizeFinished(newPos, newSize);
 
-    updateFromWidget();
+    // The update is recursive. A parent update covers this manipulator and its children.
+    if (parentItem())
+        static_cast<CEGUIManipulator*>(parentItem())->updateFromWidget(true);
+    else
+        updateFromWidget();
 
     for (QGraphicsItem* childItem : childItems())
-    {
-        CEGUIManipulator* child = dynamic_cast<CEGUIManipulator*>(childItem);
-        if (child)
-        {
-            child->updateFromWidget();
+        if (auto child = dynamic_cast<CEGUIManipulator*>(childItem))
             child->setVisible(true);
-        }
-    }
 
     // Show siblings in the same layout container
     if (isInLayoutContainer())
         for (auto item : parentItem()->childItems())
             if (item != this && dynamic_cast<CEGUIManipulator*>(item))
                 item->setVisible(true);
-
-    if (parentItem())
-        static_cast<CEGUIManipulator*>(parentItem())->updateFromWidget(true);
 }
 
 void CEGUIManipulator::notifyMoveStarted()
@@ -578,17 +558,12 @@ void CEGUIManipulator::notifyMoveFinished(QPointF newPos)
 {
     ResizableRectItem::notifyMoveFinished(newPos);
 
+    // The update is recursive, children are updated too
     updateFromWidget();
 
     for (QGraphicsItem* childItem : childItems())
-    {
-        CEGUIManipulator* child = dynamic_cast<CEGUIManipulator*>(childItem);
-        if (child)
-        {
-            child->updateFromWidget();
+        if (auto child = dynamic_cast<CEGUIManipulator*>(childItem))
             child->setVisible(true);
-        }
-    }
 }
 
 // Updates this manipulator with associated widget properties. Mainly position and size.
@@ -785,31 +760,45 @@ CEGUIManipulator* CEGUIManipulator::getManipulatorByPath(QStringRef widgetPath)
 
 // TODO: to CEGUIUtils? Pass widget instead of manipulator?
 void CEGUIManipulator::forEachChildWidget(std::function<void (CEGUI::Window*)> callback) const
+{
+    const size_t count = getChildWidgetCount();
+    for (size_t i = 0; i < count; ++i)
+        callback(getChildWidgetAtIndex(i));
+}
+
+// Child widgets as seen by the editor, i.e. tab contents for TabControl and content pane children for ScrollablePane
+size_t CEGUIManipulator::getChildWidgetCount() const
 {
     if (auto tabControl = dynamic_cast<CEGUI::TabControl*>(_widget))
-    {
-        const size_t count = tabControl->getTabCount();
-        for (size_t i = 0; i < count; ++i)
-            callback(tabControl->getTabContentsAtIndex(i));
-    }
+        return tabControl->getTabCount();
     else if (auto scrollablePane = dynamic_cast<CEGUI::ScrollablePane*>(_widget))
-    {
-        const size_t count = scrollablePane->getContentPane()->getChildCount();
-        for (size_t i = 0; i < count; ++i)
-            callback(scrollablePane->getContentPane()->getChildAtIndex(i));
-    }
+        return scrollablePane->getContentPane()->getChildCount();
     else
-    {
-        const size_t count = _widget->getChildCount();
-        for (size_t i = 0; i < count; ++i)
-            callback(_widget->getChildAtIndex(i));
-    }
+        return _widget->getChildCount();
+}
+
+CEGUI::Window* CEGUIManipulator::getChildWidgetAtIndex(size_t index) const
+{
+    if (auto tabControl = dynamic_cast<CEGUI::TabControl*>(_widget))
+        return tabControl->getTabContentsAtIndex(index);
+    else if (auto scrollablePane = dynamic_cast<CEGUI::ScrollablePane*>(_widget))
+        return scrollablePane->getContentPane()->getChildAtIndex(index);
+    else
+        return _widget->getChildAtIndex(index);
 }
 
 // Goes through child widgets of the manipulated widget and creates manipulator for each one.
 // recursive - recurse into children?
 // skipAutoWidgets - if true, auto widgets will be skipped over
 // checkExisting - hint to skip search, useful for initial construction
+bool CEGUIManipulator::shouldCreateChildManipulator(CEGUI::Window* childWidget, bool skipAutoWidgets) const
+{
+    if (!childWidget->isAutoWindow()) return true;
+
+    // Grid LC creates dummy placeholder auto-widgets. We don't want manipulators for them.
+    return !skipAutoWidgets && !dynamic_cast<CEGUI::GridLayoutContainer*>(_widget);
+}
+
 void CEGUIManipulator::createChildManipulators(bool recursive, bool skipAutoWidgets, bool checkExisting)
 {
     forEachChildWidget([this, skipAutoWidgets, recursive, checkExisting](CEGUI::Window* childWidget)
@@ -817,12 +806,8 @@ void CEGUIManipulator::createChildManipulators(bool recursive, bool skipAutoWidg
         if (checkExisting && getManipulatorByPath(CEGUIUtils::stringToQString(childWidget->getName())))
             return;
 
-        if (childWidget->isAutoWindow())
-        {
-            // Grid LC creates dummy placeholder auto-widgets. We don't want manipulators for them.
-            if (skipAutoWidgets || dynamic_cast<CEGUI::GridLayoutContainer*>(_widget))
-                return;
-        }
+        if (!shouldCreateChildManipulator(childWidget, skipAutoWidgets))
+            return;
 
         auto childManipulator = createChildManipulator(childWidget);
         childManipulator->updateFromWidget();
@@ -841,6 +826,8 @@ void CEGUIManipulator::moveToFront()
         if (item != this)
             item->stackBefore(this);
 
+    onStackingChanged();
+
     static_cast<CEGUIManipulator*>(parentItem())->moveToFront();
 }
 
@@ -858,18 +845,17 @@ static void updatePropertyFromWidget(CEGUI::Window& widget, const CEGUI::Propert
         prop.addState(QtnPropertyStateImmutable);
 }
 
-// Notify the property manager that the values of the given properties have changed for this widget
+// Notify the property manager that the values of the given properties have changed for this widget.
+// Without a property set there is nothing to update, it will read actual values when built.
 void CEGUIManipulator::updatePropertiesFromWidget(const QStringList& propertyNames)
 {
     for (const QString& propertyName : propertyNames)
     {
         auto it = _propertyMap.find(propertyName);
         if (it != _propertyMap.end())
-        {
             updatePropertyFromWidget(*_widget, *it->second.first, *it->second.second);
 
-            if (propertyName == "Name") onWidgetNameChanged();
-        }
+        if (propertyName == "Name") onWidgetNameChanged();
     }
 }
 
@@ -881,19 +867,81 @@ void CEGUIManipulator::updateAllPropertiesFromWidget()
     onWidgetNameChanged();
 }
 
-void CEGUIManipulator::createPropertySet()
+// Builds the property set on the first request
+QtnPropertySet* CEGUIManipulator::getPropertySet()
 {
-    _propertyMap.clear();
-    if (_propertySet) delete _propertySet;
+    if (_propertySet)
+    {
+        PropertySetLRU.splice(PropertySetLRU.begin(), PropertySetLRU, _propertySetLRUIt);
+        return _propertySet;
+    }
 
-    if (!_widget)
+    createPropertySet();
+    if (!_propertySet) return nullptr;
+
+    PropertySetLRU.push_front(this);
+    _propertySetLRUIt = PropertySetLRU.begin();
+
+    // Sets may be requested in a loop (e.g. for multiselection) and the previous selection may still
+    // be displayed, so eviction is postponed until the current operation is finished
+    if (PropertySetLRU.size() > MaxCachedPropertySets && !PropertySetEvictionScheduled)
     {
-        _propertySet = nullptr;
-        return;
+        PropertySetEvictionScheduled = true;
+        QTimer::singleShot(0, &CEGUIManipulator::evictPropertySets);
     }
 
+    return _propertySet;
+}
+
+void CEGUIManipulator::evictPropertySets()
+{
+    PropertySetEvictionScheduled = false;
+
+    auto it = PropertySetLRU.end();
+    while (PropertySetLRU.size() > MaxCachedPropertySets && it != PropertySetLRU.begin())
+    {
+        CEGUIManipulator* manipulator = *(--it);
+
+        // Sets of selected manipulators are or will be shown in the property editor
+        if (manipulator->isSelected() || manipulator->_propertySetPinned) continue;
+
+        it = PropertySetLRU.erase(it);
+        manipulator->_propertyMap.clear();
+        delete manipulator->_propertySet;
+        manipulator->_propertySet = nullptr;
+    }
+}
+
+void CEGUIManipulator::destroyPropertySet()
+{
+    if (!_propertySet) return;
+
+    PropertySetLRU.erase(_propertySetLRUIt);
+    _propertyMap.clear();
+    delete _propertySet;
+    _propertySet = nullptr;
+}
+
+// Fills a widget type specific data for the property. It is the same for all widgets of the type, look and renderer.
+static void initPropertySchemaEntry(CEGUIManager::PropertySchemaEntry& entry, const CEGUI::Window& widget, const CEGUI::Property& ceguiProp)
+{
+    entry.category = CEGUIUtils::stringToQString(ceguiProp.getOrigin());
+    if (entry.category.startsWith("CEGUI/")) entry.category = entry.category.mid(6);
+    entry.description = CEGUIUtils::stringToQString(ceguiProp.getHelp());
+    entry.dataType = ceguiProp.getDataType(); // could be overridden through a property map
+    entry.defaultValue = ceguiProp.getDefault(&widget);
+}
+
+void CEGUIManipulator::createPropertySet()
+{
+    assert(!_propertySet && _propertyMap.empty());
+
+    if (!_widget) return;
+
     _propertySet = new QtnPropertySet(nullptr);
 
+    auto& schema = CEGUIManager::Instance().getPropertySchema(*_widget);
+
     std::map<QString, QtnPropertySet*> subsets;
     auto it = _widget->getPropertyIterator();
     while (!it.isAtEnd())
@@ -906,11 +954,18 @@ void CEGUIManipulator::createPropertySet()
             continue;
         }
 
+        QString propName = CEGUIUtils::stringToQString(ceguiProp->getName());
+        auto itEntry = schema.find(propName);
+        if (itEntry == schema.end())
+        {
+            itEntry = schema.emplace(propName, CEGUIManager::PropertySchemaEntry{}).first;
+            initPropertySchemaEntry(itEntry->second, *_widget, *ceguiProp);
+        }
+        const auto& schemaEntry = itEntry->second;
+
         // Categorize properties by CEGUI property origin
         QtnPropertySet* parentSet = _propertySet;
-        QString propName = CEGUIUtils::stringToQString(ceguiProp->getName());
-        QString category = CEGUIUtils::stringToQString(ceguiProp->getOrigin());
-        if (category.startsWith("CEGUI/")) category = category.mid(6);
+        QString category = schemaEntry.category;
         if (!category.isEmpty())
         {
             auto it = subsets.find(category);
@@ -926,25 +981,25 @@ void CEGUIManipulator::createPropertySet()
         }
 
         QtnProperty* prop = nullptr;
-        const auto& propertyDataType = ceguiProp->getDataType(); // could be overridden through a property map
+        const auto& propertyDataType = schemaEntry.dataType;
         if (propertyDataType == "bool")
             prop = new QtnPropertyBool(parentSet);
         else if (propertyDataType == "std::uint32_t")
         {
             auto typedProp = new QtnPropertyUInt(parentSet);
-            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::uint32_t>().fromString(ceguiProp->getDefault(_widget)));
+            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::uint32_t>().fromString(schemaEntry.defaultValue));
             prop = typedProp;
         }
         else if (propertyDataType == "std::uint64_t")
         {
             auto typedProp = new QtnPropertyUInt64(parentSet);
-            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::uint64_t>().fromString(ceguiProp->getDefault(_widget)));
+            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::uint64_t>().fromString(schemaEntry.defaultValue));
             prop = typedProp;
         }
         else if (propertyDataType == "int16")
         {
             auto typedProp = new QtnPropertyInt(parentSet);
-            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::int16_t>().fromString(ceguiProp->getDefault(_widget)));
+            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::int16_t>().fromString(schemaEntry.defaultValue));
             typedProp->setMinValue(std::numeric_limits<uint16_t>().min());
             typedProp->setMaxValue(std::numeric_limits<uint16_t>().max());
             prop = typedProp;
@@ -952,25 +1007,25 @@ void CEGUIManipulator::createPropertySet()
         else if (propertyDataType == "int32")
         {
             auto typedProp = new QtnPropertyInt(parentSet);
-            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::int32_t>().fromString(ceguiProp->getDefault(_widget)));
+            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::int32_t>().fromString(schemaEntry.defaultValue));
             prop = typedProp;
         }
         else if (propertyDataType == "int64")
         {
             auto typedProp = new QtnPropertyInt64(parentSet);
-            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::int64_t>().fromString(ceguiProp->getDefault(_widget)));
+            typedProp->setDefaultValue(CEGUI::PropertyHelper<std::int64_t>().fromString(schemaEntry.defaultValue));
             prop = typedProp;
         }
         else if (propertyDataType == "float")
         {
             auto typedProp = new QtnPropertyFloat(parentSet);
-            typedProp->setDefaultValue(CEGUI::PropertyHelper<float>().fromString(ceguiProp->getDefault(_widget)));
+            typedProp->setDefaultValue(CEGUI::PropertyHelper<float>().fromString(schemaEntry.defaultValue));
             prop = typedProp;
         }
         else if (propertyDataType == "double")
         {
             auto typedProp = new QtnPropertyDouble(parentSet);
-            typedProp->setDefaultValue(CEGUI::PropertyHelper<double>().fromString(ceguiProp->getDefault(_widget)));
+            typedProp->setDefaultValue(CEGUI::PropertyHelper<double>().fromString(schemaEntry.defaultValue));
             prop = typedProp;
         }
         else if (propertyDataType == "HorizontalAlignment")
@@ -1136,9 +1191,14 @@ void CEGUIManipulator::createPropertySet()
 
             if (propertyDataType != "String")
             {
-                const QString type = CEGUIUtils::stringToQString(propertyDataType);
-                QMessageBox::warning(nullptr, "Unknown property type",
-                                     QString("Property type '%1' is unknown, string inspector will be used").arg(type));
+                // Property sets are rebuilt on demand, don't annoy the user with the same warning every time
+                static std::set<CEGUI::String> reportedTypes;
+                if (reportedTypes.insert(propertyDataType).second)
+                {
+                    const QString type = CEGUIUtils::stringToQString(propertyDataType);
+                    QMessageBox::warning(nullptr, "Unknown property type",
+                                         QString("Property type '%1' is unknown, string inspector will be used").arg(type));
+                }
             }
             else
             {
@@ -1149,7 +1209,7 @@ void CEGUIManipulator::createPropertySet()
         }
 
         prop->setName(propName);
-        prop->setDescription(CEGUIUtils::stringToQString(ceguiProp->getHelp()));
+        prop->setDescription(schemaEntry.description);
         prop->fromStr(CEGUIUtils::stringToQString(ceguiProp->get(_widget)));
         prop->addState(QtnPropertyStateCollapsed);
         if (!ceguiProp->isWritable())
@@ -6,7 +6,9 @@
 #include <CEGUI/USize.h>
 #include <CEGUI/Sizef.h>
 #include "src/QtStdHash.h"
+#include <qpainterpath.h>
 #include <unordered_map>
+#include <list>
 
 // This is a rectangle that is synchronised with given CEGUI widget,
 // it provides moving and resizing functionality
@@ -58,6 +60,8 @@ public:
 
     // Returns whether the painting code should strive to prevent manipulator overlap (crossing outlines and possibly other things)
     virtual bool preventManipulatorOverlap() const { return false; }
+    // Returns a scene space clip path that excludes manipulators stacked above this one
+    virtual QPainterPath getOverlapClipPath() const;
     virtual bool useAbsoluteCoordsForMove() const { return false; }
     virtual bool useAbsoluteCoordsForResize() const { return false; }
     virtual bool useIntegersForAbsoluteMove() const { return false; }
@@ -75,7 +79,10 @@ public:
     CEGUIManipulator* getManipulatorByPath(const QString& widgetPath) const { return getManipulatorByPath(QStringRef(&widgetPath)); }
     CEGUIManipulator* getManipulatorByPath(QStringRef widgetPath) const;
     void forEachChildWidget(std::function<void (CEGUI::Window*)> callback) const;
+    size_t getChildWidgetCount() const;
+    CEGUI::Window* getChildWidgetAtIndex(size_t index) const;
 
+    bool shouldCreateChildManipulator(CEGUI::Window* childWidget, bool skipAutoWidgets) const;
     void createChildManipulators(bool recursive, bool skipAutoWidgets, bool checkExisting);
     void moveToFront();
     bool shouldBeSkipped() const;
@@ -84,7 +91,9 @@ public:
 
     void updatePropertiesFromWidget(const QStringList& propertyNames);
     void updateAllPropertiesFromWidget();
-    QtnPropertySet* getPropertySet() const { return _propertySet; }
+    QtnPropertySet* getPropertySet();
+    bool hasPropertySet() const { return _propertySet != nullptr; }
+    void setPropertySetPinned(bool pinned) { _propertySetPinned = pinned; } // Pinned set is never evicted
 
     bool isMoveStarted() const { return _moveStarted; }
     void resetMove() { _moveStarted = false; }
@@ -96,10 +105,14 @@ public:
 
 protected:
 
+    static void evictPropertySets();
+
     void createPropertySet();
+    void destroyPropertySet();
     void adjustPositionDeltaOnResize(CEGUI::UVector2& deltaPos, const CEGUI::USize& deltaSize);
 
     virtual void onWidgetNameChanged();
+    virtual void onStackingChanged() {}
     void updateTooltip();
 
     virtual QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
@@ -107,8 +120,11 @@ protected:
     virtual void impl_paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr);
 
     CEGUI::Window* _widget = nullptr;
+    // Property sets are built on demand and only a limited number of recently used ones is kept
     QtnPropertySet* _propertySet = nullptr;
     std::unordered_map<QString, std::pair<CEGUI::Property*, QtnProperty*>> _propertyMap;
+    std::list<CEGUIManipulator*>::iterator _propertySetLRUIt; // Valid only when _propertySet exists
+    bool _propertySetPinned = false;
 
     bool _resizeStarted = false;
     bool _moveStarted = false;
@@ -0,0 +1,138 @@
+#include "src/cegui/CEGUIResourcePrefetcher.h"
+#include "src/cegui/CEGUIProject.h"
+#include "src/util/FunctionTask.h"
+#include <qelapsedtimer.h>
+#include <qfile.h>
+#include <qdom.h>
+
+CEGUIResourcePrefetcher::CEGUIResourcePrefetcher(const CEGUIProject& project)
+    : _project(project)
+    , _cancelled(false)
+{
+}
+
+CEGUIResourcePrefetcher::~CEGUIResourcePrefetcher()
+{
+    cancel();
+    _pool.waitForDone();
+}
+
+void CEGUIResourcePrefetcher::prefetchScheme(const QString& schemeFile)
+{
+    enqueue(schemeFile, "schemes", FileType::Scheme);
+}
+
+void CEGUIResourcePrefetcher::cancel()
+{
+    _cancelled = true;
+    _pool.clear();
+
+    // Wake up anyone waiting for files that will never be read
+    QMutexLocker lock(&_mutex);
+    for (auto& pair : _files)
+        pair.second.ready = true;
+    _fileReady.wakeAll();
+}
+
+QByteArray CEGUIResourcePrefetcher::takeData(const QString& fileName, const QString& resourceGroup, qint64* outReadTimeMs)
+{
+    const QString filePath = _project.getResourceFilePath(fileName, resourceGroup);
+
+    QMutexLocker lock(&_mutex);
+
+    auto it = _files.find(filePath);
+    if (it == _files.end()) return QByteArray();
+
+    while (!it->second.ready)
+    {
+        _fileReady.wait(&_mutex);
+        it = _files.find(filePath);
+    }
+
+    if (outReadTimeMs) *outReadTimeMs = it->second.readTimeMs;
+
+    // Data is consumed only once, keep the entry to prevent reading the file again
+    QByteArray data;
+    std::swap(data, it->second.data);
+    return data;
+}
+
+void CEGUIResourcePrefetcher::enqueue(const QString& fileName, const QString& resourceGroup, FileType type)
+{
+    if (_cancelled) return;
+
+    const QString filePath = _project.getResourceFilePath(fileName, resourceGroup);
+    if (filePath.isEmpty()) return;
+
+    {
+        QMutexLocker lock(&_mutex);
+
+        // Shared resources (e.g. an imageset used by multiple schemes) are read only once
+        if (!_files.emplace(filePath, FileRequest()).second) return;
+    }
+
+    _pool.start(new FunctionTask([this, filePath, type]()
+    {
+        processFile(filePath, type);
+    }));
+}
+
+// Executed in a worker thread
+void CEGUIResourcePrefetcher::processFile(const QString& filePath, FileType type)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QByteArray data;
+    if (!_cancelled)
+    {
+        QFile file(filePath);
+        if (file.open(QIODevice::ReadOnly))
+            data = file.readAll();
+    }
+
+    const qint64 readTimeMs = timer.elapsed();
+
+    if (!_cancelled && !data.isEmpty())
+        processDependencies(data, type);
+
+    QMutexLocker lock(&_mutex);
+    auto& request = _files[filePath];
+    request.data = std::move(data);
+    request.readTimeMs = readTimeMs;
+    request.ready = true;
+    _fileReady.wakeAll();
+}
+
+// Executed in a worker thread. Discovers files referenced by the scheme and schedules them for reading.
+// Image and font files referenced by imagesets and fonts are not prefetched, CEGUI loads them through its
+// resource provider, which would read them again.
+void CEGUIResourcePrefetcher::processDependencies(const QByteArray& data, FileType type)
+{
+    if (type != FileType::Scheme) return;
+
+    QDomDocument doc;
+    if (!doc.setContent(data)) return;
+
+    const auto root = doc.documentElement();
+
+    auto getGroup = [](const QDomElement& element, const QString& defaultGroup)
+    {
+        const QString group = element.attribute("resourceGroup");
+        return group.isEmpty() ? defaultGroup : group;
+    };
+
+    for (auto element = root.firstChildElement(); !element.isNull(); element = element.nextSiblingElement())
+    {
+        const QString fileName = element.attribute("filename");
+        if (fileName.isEmpty()) continue;
+
+        const QString tag = element.tagName();
+        if (tag == "Imageset")
+            enqueue(fileName, getGroup(element, "imagesets"), FileType::Imageset);
+        else if (tag == "Font")
+            enqueue(fileName, getGroup(element, "fonts"), FileType::Font);
+        else if (tag == "LookNFeel")
+            enqueue(fileName, getGroup(element, "looknfeels"), FileType::LookNFeel);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef CEGUIRESOURCEPREFETCHER_H
+#define CEGUIRESOURCEPREFETCHER_H
+
+#include "src/QtStdHash.h"
+#include <qbytearray.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
+#include <qthreadpool.h>
+#include <unordered_map>
+#include <atomic>
+
+// Reads project resource files on a thread pool ahead of CEGUI. CEGUI itself is not thread safe and
+// must create its resources in the main thread with the OpenGL context active, but it doesn't have to
+// wait for disk I/O. Schemes are parsed in workers to discover files they reference, so XML resources
+// of all schemes are being read in parallel while CEGUI processes the data already available.
+
+class CEGUIProject;
+
+class CEGUIResourcePrefetcher
+{
+public:
+
+    CEGUIResourcePrefetcher(const CEGUIProject& project);
+    ~CEGUIResourcePrefetcher();
+
+    void prefetchScheme(const QString& schemeFile);
+    void cancel();
+
+    // Blocks until the file is read. Returns a null array if the file wasn't requested or can't be read.
+    QByteArray takeData(const QString& fileName, const QString& resourceGroup, qint64* outReadTimeMs = nullptr);
+
+protected:
+
+    struct FileRequest
+    {
+        QByteArray data;
+        qint64 readTimeMs = 0;
+        bool ready = false;
+    };
+
+    enum class FileType
+    {
+        Scheme,
+        Imageset,
+        Font,
+        LookNFeel
+    };
+
+    void enqueue(const QString& fileName, const QString& resourceGroup, FileType type);
+    void processFile(const QString& filePath, FileType type);
+    void processDependencies(const QByteArray& data, FileType type);
+
+    const CEGUIProject& _project;
+    QThreadPool _pool;
+    QMutex _mutex;
+    QWaitCondition _fileReady;
+    std::unordered_map<QString, FileRequest> _files; // Absolute path -> data
+    std::atomic<bool> _cancelled;
+};
+
+#endif // CEGUIRESOURCEPREFETCHER_H
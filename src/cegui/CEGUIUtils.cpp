@@ -6,6 +6,8 @@
 #include <CEGUI/WindowManager.h>
 #include <CEGUI/widgets/TabControl.h>
 #include <CEGUI/widgets/ButtonBase.h>
+#include <CEGUI/falagard/WidgetLookManager.h>
+#include <CEGUI/falagard/WidgetLookFeel.h>
 #include <qdatastream.h>
 
 namespace CEGUIUtils
@@ -81,18 +83,24 @@ void removeNestedPaths(QStringList& paths)
     }), paths.end());
 }
 
-bool serializeWidget(const CEGUI::Window& widget, QDataStream& stream, bool recursive)
+// Collects properties to be saved. Default values are skipped only when it is safe: LookNFeel can override
+// a property value, and if we don't save it we can lose it. E.g. auto-surface is false by default but
+// TaharezLook/FrameWindow sets it to true. So if we don't save 'false' because it is default we will
+// get 'true' from LnF after deserialization.
+void getSerializableProperties(const CEGUI::Window& widget, bool skipDefaults, std::vector<std::pair<CEGUI::String, CEGUI::String>>& outProperties)
 {
-    if (!stream.device()->isWritable()) return false;
-
-    stream << stringToQString(widget.getName());
-    stream << stringToQString(widget.getType());
-    stream << widget.isAutoWindow();
-
-    const auto propertyCounterPosition = stream.device()->pos();
+    // Auto windows may also be initialised by a child definition in the parent's LookNFeel, don't risk
+    if (widget.isAutoWindow()) skipDefaults = false;
 
-    uint16_t propertyCount = 0;
-    stream << propertyCount;
+    const CEGUI::WidgetLookFeel* wlf = nullptr;
+    if (skipDefaults && !widget.getLookNFeel().empty())
+    {
+        auto& wlfManager = CEGUI::WidgetLookManager::getSingleton();
+        if (wlfManager.isWidgetLookAvailable(widget.getLookNFeel()))
+            wlf = &wlfManager.getWidgetLook(widget.getLookNFeel());
+        else
+            skipDefaults = false;
+    }
 
     auto it = widget.getPropertyIterator();
     while (!it.isAtEnd())
@@ -102,39 +110,21 @@ bool serializeWidget(const CEGUI::Window& widget, QDataStream& stream, bool recu
 
         if (widget.isPropertyBannedFromXML(propertyName)) continue;
 
-        // FIXME IN CEGUI: LookNFeel can override property value, and if we don't save it we can lose it.
-        // E.g. auto-surface is false by default but TaharezLook/FrameWindow sets it to true. So if we
-        // don't save 'false' because it is default we will get 'true' from LnF after deserialization.
-        //if (widget.isPropertyDefault(propertyName)) continue;
+        if (skipDefaults && widget.isPropertyDefault(propertyName) && (!wlf || !wlf->findPropertyInitialiser(propertyName)))
+            continue;
 
-        const auto propertyValue = widget.getProperty(propertyName);
+        auto propertyValue = widget.getProperty(propertyName);
 
         // It is OK to have no renderer but not to set the empty name. Strange.
         if (propertyName == "WindowRenderer" && propertyValue.empty()) continue;
 
-        stream << stringToQString(propertyName);
-        stream << stringToQString(propertyValue);
-        ++propertyCount;
-    }
-
-    auto currPosition = stream.device()->pos();
-    stream.device()->seek(propertyCounterPosition);
-    stream << propertyCount;
-    stream.device()->seek(currPosition);
-
-    if (!recursive)
-    {
-        stream << static_cast<uint16_t>(0); // Child count
-        return true;
+        outProperties.emplace_back(propertyName, std::move(propertyValue));
     }
+}
 
-    assert(widget.getChildCount() <= std::numeric_limits<uint16_t>().max());
-
-    const auto childCounterPosition = stream.device()->pos();
-
-    uint16_t childCount = 0;
-    stream << childCount;
-
+// Collects children in the order they must be deserialized in
+void getSerializableChildren(const CEGUI::Window& widget, std::vector<const CEGUI::Window*>& outChildren)
+{
     // Some widget types require special processing due to overridden writeChildWindowsXML().
     // TODO: move to CEGUI side, implement universal format-agnostic (de)serialization there!
     auto tabCtl = dynamic_cast<const CEGUI::TabControl*>(&widget);
@@ -144,9 +134,8 @@ bool serializeWidget(const CEGUI::Window& widget, QDataStream& stream, bool recu
     {
         const CEGUI::Window* child = widget.getChildAtIndex(i);
         assert(child);
-        if (child->isAutoWindow()) continue;
-        serializeWidget(*child, stream, true);
-        ++childCount;
+        if (!child->isAutoWindow())
+            outChildren.push_back(child);
     }
 
     // Then serialize auto-windows. Some of them may depend on normal children, e.g. TabControl buttons.
@@ -160,10 +149,8 @@ bool serializeWidget(const CEGUI::Window& widget, QDataStream& stream, bool recu
         {
             // Save tabs as direct children of the TabControl
             const size_t tabCount = tabCtl->getTabCount();
-            assert(widget.getChildCount() + tabCount - 1 <= std::numeric_limits<uint16_t>().max());
             for (size_t j = 0; j < tabCount; ++j)
-                serializeWidget(*tabCtl->getTabContentsAtIndex(j), stream, true);
-            childCount += static_cast<uint16_t>(tabCount);
+                outChildren.push_back(tabCtl->getTabContentsAtIndex(j));
         }
         else if (tabCtl && child->getName() == CEGUI::TabControl::TabButtonPaneName)
         {
@@ -171,30 +158,14 @@ bool serializeWidget(const CEGUI::Window& widget, QDataStream& stream, bool recu
         }
         else
         {
-            serializeWidget(*child, stream, true);
-            ++childCount;
+            outChildren.push_back(child);
         }
     }
-
-    currPosition = stream.device()->pos();
-    stream.device()->seek(childCounterPosition);
-    stream << childCount;
-    stream.device()->seek(currPosition);
-
-    return true;
 }
 
-CEGUI::Window* deserializeWidget(QDataStream& stream, CEGUI::Window* parent, size_t index)
+// Creates a deserialized widget or finds an existing auto widget in the parent
+CEGUI::Window* createSerializedWidget(const CEGUI::String& name, const CEGUI::String& type, bool isAutoWidget, CEGUI::Window* parent, size_t index)
 {
-    QString name, type;
-    stream >> name;
-    stream >> type;
-
-    bool isAutoWidget = false;
-    stream >> isAutoWidget;
-
-    CEGUI::Window* widget = nullptr;
-
     if (isAutoWidget)
     {
         if (!parent)
@@ -202,28 +173,71 @@ CEGUI::Window* deserializeWidget(QDataStream& stream, CEGUI::Window* parent, siz
             assert(false && "Root widget can't be an auto widget!");
             return nullptr;
         }
-        else
+
+        CEGUI::Window* widget = parent->getChild(name);
+        if (!widget || widget->getType() != type)
         {
-            widget = parent->getChild(qStringToString(name));
-            if (!widget || widget->getType() != qStringToString(type))
-            {
-                assert(false && "Skipping widget construction because it's an auto widget, the types don't match though!");
-                return nullptr;
-            }
+            assert(false && "Skipping widget construction because it's an auto widget, the types don't match though!");
+            return nullptr;
         }
+
+        return widget;
     }
-    else
+
+    const CEGUI::String widgetName = parent ? getUniqueChildWidgetName(*parent, name) : name;
+    CEGUI::Window* widget = CEGUI::WindowManager::getSingleton().createWindow(type, widgetName);
+    if (parent && !insertChild(parent, widget, index))
     {
-        CEGUI::String widgetName = qStringToString(name);
-        if (parent) widgetName = getUniqueChildWidgetName(*parent, widgetName);
-        widget = CEGUI::WindowManager::getSingleton().createWindow(qStringToString(type), widgetName);
-        if (parent && !insertChild(parent, widget, index))
-        {
-            CEGUI::WindowManager::getSingleton().destroyWindow(widget);
-            return nullptr;
-        }
+        CEGUI::WindowManager::getSingleton().destroyWindow(widget);
+        return nullptr;
     }
 
+    return widget;
+}
+
+// Full serialization format that saves all properties, see CEGUIWidgetSerializer for the compact one
+bool serializeWidget(const CEGUI::Window& widget, QDataStream& stream, bool recursive)
+{
+    if (!stream.device()->isWritable()) return false;
+
+    stream << stringToQString(widget.getName());
+    stream << stringToQString(widget.getType());
+    stream << widget.isAutoWindow();
+
+    std::vector<std::pair<CEGUI::String, CEGUI::String>> properties;
+    getSerializableProperties(widget, false, properties);
+
+    assert(properties.size() <= std::numeric_limits<uint16_t>().max());
+    stream << static_cast<uint16_t>(properties.size());
+    for (const auto& property : properties)
+    {
+        stream << stringToQString(property.first);
+        stream << stringToQString(property.second);
+    }
+
+    std::vector<const CEGUI::Window*> children;
+    if (recursive) getSerializableChildren(widget, children);
+
+    assert(children.size() <= std::numeric_limits<uint16_t>().max());
+    stream << static_cast<uint16_t>(children.size());
+    for (const CEGUI::Window* child : children)
+        serializeWidget(*child, stream, true);
+
+    return true;
+}
+
+CEGUI::Window* deserializeWidget(QDataStream& stream, CEGUI::Window* parent, size_t index)
+{
+    QString name, type;
+    stream >> name;
+    stream >> type;
+
+    bool isAutoWidget = false;
+    stream >> isAutoWidget;
+
+    CEGUI::Window* widget = createSerializedWidget(qStringToString(name), qStringToString(type), isAutoWidget, parent, index);
+    if (!widget) return nullptr;
+
     uint16_t propertyCount = 0;
     stream >> propertyCount;
     for (uint16_t i = 0; i < propertyCount; ++i)
@@ -3,6 +3,8 @@
 
 #include "qstring.h"
 #include <CEGUI/InputEvent.h>
+#include <vector>
+#include <utility>
 
 namespace CEGUI
 {
@@ -24,6 +26,9 @@ namespace CEGUIUtils
     QString getRelativePath(const CEGUI::Window* widget, const CEGUI::Window* parent);
     void removeNestedPaths(QStringList& paths);
 
+    void getSerializableProperties(const CEGUI::Window& widget, bool skipDefaults, std::vector<std::pair<CEGUI::String, CEGUI::String>>& outProperties);
+    void getSerializableChildren(const CEGUI::Window& widget, std::vector<const CEGUI::Window*>& outChildren);
+    CEGUI::Window* createSerializedWidget(const CEGUI::String& name, const CEGUI::String& type, bool isAutoWidget, CEGUI::Window* parent, size_t index);
     bool serializeWidget(const CEGUI::Window& widget, QDataStream& stream, bool recursive);
     CEGUI::Window* deserializeWidget(QDataStream& stream, CEGUI::Window* parent = nullptr, size_t index = std::numeric_limits<size_t>().max());
 
@@ -0,0 +1,260 @@
+#include "src/cegui/CEGUIWidgetSerializer.h"
+#include "src/cegui/CEGUIUtils.h"
+#include <CEGUI/Window.h>
+#include "zlib.h"
+#include <unordered_map>
+#include <algorithm>
+#include <cassert>
+
+static const quint32 FormatSignature = 0x43574831; // "CWH1"
+static const quint8 FormatVersion = 1;
+static const quint8 FlagCompressed = 0x01;
+static const int MinSizeToCompress = 512; // Compression of smaller data isn't worth the effort
+static const quint32 MaxPayloadSize = 1024 * 1024 * 1024;
+
+constexpr const char* CEGUIWidgetSerializer::MimeType;
+
+namespace
+{
+
+struct WidgetRecord
+{
+    quint32 name = 0;
+    quint32 type = 0;
+    bool isAutoWindow = false;
+    std::vector<std::pair<quint32, quint32>> properties;
+    quint16 childCount = 0;
+};
+
+class StringTable
+{
+public:
+
+    quint32 intern(const CEGUI::String& str)
+    {
+        auto it = _indices.find(str);
+        if (it != _indices.end()) return it->second;
+
+        const quint32 index = static_cast<quint32>(_strings.size());
+        it = _indices.emplace(str, index).first;
+        _strings.push_back(&it->first);
+        return index;
+    }
+
+    const std::vector<const CEGUI::String*>& getStrings() const { return _strings; }
+
+private:
+
+    std::unordered_map<CEGUI::String, quint32> _indices;
+    std::vector<const CEGUI::String*> _strings; // Ordered by index, point to map keys
+};
+
+}
+
+// Records are written in a depth-first order, exactly as they will be read
+static void collectWidget(const CEGUI::Window& widget, bool recursive, StringTable& strings, std::vector<WidgetRecord>& records)
+{
+    const size_t recordIndex = records.size();
+    records.emplace_back();
+
+    {
+        WidgetRecord& record = records.back();
+        record.name = strings.intern(widget.getName());
+        record.type = strings.intern(widget.getType());
+        record.isAutoWindow = widget.isAutoWindow();
+
+        std::vector<std::pair<CEGUI::String, CEGUI::String>> properties;
+        CEGUIUtils::getSerializableProperties(widget, true, properties);
+
+        assert(properties.size() <= std::numeric_limits<quint16>().max());
+        record.properties.reserve(properties.size());
+        for (const auto& property : properties)
+            record.properties.emplace_back(strings.intern(property.first), strings.intern(property.second));
+    }
+
+    if (!recursive) return;
+
+    std::vector<const CEGUI::Window*> children;
+    CEGUIUtils::getSerializableChildren(widget, children);
+
+    assert(children.size() <= std::numeric_limits<quint16>().max());
+    records[recordIndex].childCount = static_cast<quint16>(children.size());
+    for (const CEGUI::Window* child : children)
+        collectWidget(*child, true, strings, records);
+}
+
+QByteArray CEGUIWidgetSerializer::serialize(const std::vector<const CEGUI::Window*>& widgets, bool recursive, bool compress)
+{
+    // Collect everything first to know all counts and strings before writing
+    StringTable strings;
+    std::vector<WidgetRecord> records;
+    for (const CEGUI::Window* widget : widgets)
+        if (widget)
+            collectWidget(*widget, recursive, strings, records);
+
+    QByteArray payload;
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_6);
+
+        stream << static_cast<quint32>(strings.getStrings().size());
+        for (const CEGUI::String* str : strings.getStrings())
+            stream << CEGUIUtils::stringToQString(*str).toUtf8();
+
+        const auto nullCount = std::count(widgets.cbegin(), widgets.cend(), nullptr);
+        stream << static_cast<quint32>(widgets.size() - static_cast<size_t>(nullCount));
+
+        for (const auto& record : records)
+        {
+            stream << record.name << record.type << static_cast<quint8>(record.isAutoWindow);
+            stream << static_cast<quint16>(record.properties.size());
+            for (const auto& property : record.properties)
+                stream << property.first << property.second;
+            stream << record.childCount;
+        }
+    }
+
+    QByteArray compressed;
+    if (compress && payload.size() >= MinSizeToCompress)
+    {
+        // Interactive operations like delete and paste prefer speed to ratio
+        uLongf compressedSize = compressBound(static_cast<uLong>(payload.size()));
+        compressed.resize(static_cast<int>(compressedSize));
+        if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressedSize,
+                      reinterpret_cast<const Bytef*>(payload.constData()), static_cast<uLong>(payload.size()), Z_BEST_SPEED) == Z_OK)
+        {
+            compressed.resize(static_cast<int>(compressedSize));
+        }
+        else
+        {
+            compressed.clear();
+        }
+    }
+
+    QByteArray result;
+    QDataStream stream(&result, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << FormatSignature << FormatVersion << static_cast<quint8>(compressed.isEmpty() ? 0 : FlagCompressed);
+    stream << static_cast<quint32>(payload.size());
+
+    const QByteArray& data = compressed.isEmpty() ? payload : compressed;
+    stream.writeRawData(data.constData(), data.size());
+
+    return result;
+}
+
+CEGUIWidgetSerializer::CEGUIWidgetSerializer(const QByteArray& data)
+{
+    QDataStream header(data);
+    header.setVersion(QDataStream::Qt_5_6);
+
+    quint32 signature = 0;
+    quint8 version = 0;
+    quint8 flags = 0;
+    quint32 payloadSize = 0;
+    header >> signature >> version >> flags >> payloadSize;
+    if (header.status() != QDataStream::Ok || signature != FormatSignature || version != FormatVersion || payloadSize > MaxPayloadSize)
+        return;
+
+    const int headerSize = static_cast<int>(header.device()->pos());
+    if (flags & FlagCompressed)
+    {
+        _payload.resize(static_cast<int>(payloadSize));
+        uLongf size = payloadSize;
+        if (uncompress(reinterpret_cast<Bytef*>(_payload.data()), &size,
+                       reinterpret_cast<const Bytef*>(data.constData() + headerSize), static_cast<uLong>(data.size() - headerSize)) != Z_OK ||
+            size != payloadSize)
+        {
+            return;
+        }
+    }
+    else
+    {
+        _payload = data.mid(headerSize);
+    }
+
+    _buffer.setBuffer(&_payload);
+    _buffer.open(QIODevice::ReadOnly);
+    _stream.setDevice(&_buffer);
+    _stream.setVersion(QDataStream::Qt_5_6);
+
+    // Each string is converted only once, no matter how many widgets use it
+    quint32 stringCount = 0;
+    _stream >> stringCount;
+    _strings.reserve(stringCount);
+    for (quint32 i = 0; i < stringCount && _stream.status() == QDataStream::Ok; ++i)
+    {
+        QByteArray utf8;
+        _stream >> utf8;
+        _strings.push_back(CEGUIUtils::qStringToString(QString::fromUtf8(utf8)));
+    }
+
+    _stream >> _widgetsLeft;
+
+    _valid = (_stream.status() == QDataStream::Ok);
+}
+
+CEGUI::Window* CEGUIWidgetSerializer::deserialize(CEGUI::Window* parent, size_t index)
+{
+    if (atEnd()) return nullptr;
+
+    --_widgetsLeft;
+    return deserializeWidget(parent, index);
+}
+
+CEGUI::Window* CEGUIWidgetSerializer::deserializeWidget(CEGUI::Window* parent, size_t index)
+{
+    quint32 nameIndex = 0;
+    quint32 typeIndex = 0;
+    quint8 isAutoWindow = 0;
+    _stream >> nameIndex >> typeIndex >> isAutoWindow;
+
+    CEGUI::Window* widget = CEGUIUtils::createSerializedWidget(getString(nameIndex), getString(typeIndex), isAutoWindow != 0, parent, index);
+
+    quint16 propertyCount = 0;
+    _stream >> propertyCount;
+    for (quint16 i = 0; i < propertyCount; ++i)
+    {
+        quint32 propertyName = 0;
+        quint32 propertyValue = 0;
+        _stream >> propertyName >> propertyValue;
+        if (widget)
+            CEGUIUtils::setWidgetProperty(widget, getString(propertyName), getString(propertyValue));
+    }
+
+    quint16 childCount = 0;
+    _stream >> childCount;
+    for (quint16 i = 0; i < childCount; ++i)
+    {
+        // The data of a failed widget must be consumed anyway to keep the stream consistent
+        if (widget)
+            deserializeWidget(widget, std::numeric_limits<size_t>().max());
+        else
+            skipWidget();
+    }
+
+    return widget;
+}
+
+void CEGUIWidgetSerializer::skipWidget()
+{
+    quint32 index = 0;
+    quint8 isAutoWindow = 0;
+    _stream >> index >> index >> isAutoWindow;
+
+    quint16 propertyCount = 0;
+    _stream >> propertyCount;
+    for (quint16 i = 0; i < propertyCount; ++i)
+        _stream >> index >> index;
+
+    quint16 childCount = 0;
+    _stream >> childCount;
+    for (quint16 i = 0; i < childCount; ++i)
+        skipWidget();
+}
+
+const CEGUI::String& CEGUIWidgetSerializer::getString(quint32 index) const
+{
+    static const CEGUI::String Empty;
+    return (index < _strings.size()) ? _strings[index] : Empty;
+}
@@ -0,0 +1,52 @@
+#ifndef CEGUIWIDGETSERIALIZER_H
+#define CEGUIWIDGETSERIALIZER_H
+
+#include <qbytearray.h>
+#include <qdatastream.h>
+#include <qbuffer.h>
+#include <CEGUI/String.h>
+#include <vector>
+#include <limits>
+
+// Compact binary format of widget hierarchies for undo history and clipboard. All names, types and values
+// are interned into a single string table, properties at default values are omitted where it is safe,
+// and the result is optionally compressed with zlib. Unlike CEGUIUtils::serializeWidget, the data is
+// a self-contained blob that may hold several hierarchies, which are read back one by one.
+
+namespace CEGUI
+{
+    class Window;
+}
+
+class CEGUIWidgetSerializer
+{
+public:
+
+    // Clipboard format, differs from the XML based one used before, so that old data isn't misread
+    static constexpr const char* MimeType = "application/x-ceed-widget-hierarchy-list-v2";
+
+    static QByteArray serialize(const std::vector<const CEGUI::Window*>& widgets, bool recursive = true, bool compress = true);
+
+    CEGUIWidgetSerializer(const QByteArray& data);
+
+    bool isValid() const { return _valid; }
+    bool atEnd() const { return !_valid || _widgetsLeft == 0; }
+
+    // Reads the next hierarchy from the data
+    CEGUI::Window* deserialize(CEGUI::Window* parent = nullptr, size_t index = std::numeric_limits<size_t>().max());
+
+protected:
+
+    CEGUI::Window* deserializeWidget(CEGUI::Window* parent, size_t index);
+    void skipWidget();
+    const CEGUI::String& getString(quint32 index) const;
+
+    QByteArray _payload;
+    QBuffer _buffer;
+    QDataStream _stream;
+    std::vector<CEGUI::String> _strings;
+    quint32 _widgetsLeft = 0;
+    bool _valid = false;
+};
+
+#endif // CEGUIWIDGETSERIALIZER_H
@@ -2,6 +2,16 @@
 #include "qmessagebox.h"
 #include "qscrollbar.h"
 #include <qevent.h>
+#include <qtextcursor.h>
+#include <algorithm>
+
+// Converts document separators to the same form as QTextDocument::toPlainText does
+static QString toPlainText(QString text)
+{
+    text.replace(QChar::ParagraphSeparator, '\n');
+    text.replace(QChar::LineSeparator, '\n');
+    return text;
+}
 
 // TODO: Some highlighting and other aids
 
@@ -88,22 +98,110 @@ bool CodeEditMode::propagateToVisual()
     return propagateNativeCode(source);
 }
 
+// Starts a new generation of the code, previous undo commands are not applicable to it directly
 void CodeEditMode::setCodeWithoutUndoHistory(const QString& code)
+{
+    if (_generation) _generation->finalText = _shadowText;
+
+    setTextWithoutUndoHistory(code);
+
+    _generation = std::make_shared<CodeEditGeneration>();
+    _generation->baseText = _shadowText;
+}
+
+void CodeEditMode::setTextWithoutUndoHistory(const QString& text)
 {
     ignoreUndoCommands = true;
-    setPlainText(code);
+    setPlainText(text);
     ignoreUndoCommands = false;
+
+    _shadowText = document()->toPlainText();
+}
+
+// Commands of a generation are contiguous in the undo stack and separated by mode switches. So when
+// the generation is re-entered, the command undone is the last one and the command redone is the first.
+void CodeEditMode::enterGeneration(const std::shared_ptr<CodeEditGeneration>& generation, bool atEnd)
+{
+    if (_generation == generation) return;
+
+    if (_generation) _generation->finalText = _shadowText;
+
+    _generation = generation;
+    setTextWithoutUndoHistory(atEnd ? generation->finalText : generation->baseText);
 }
 
-void CodeEditMode::slot_contentsChange(int /*position*/, int charsRemoved, int charsAdded)
+void CodeEditMode::applyDeltas(const std::shared_ptr<CodeEditGeneration>& generation, const std::vector<CodeEditDelta>& deltas, bool undo)
 {
-    if (!ignoreUndoCommands)
+    enterGeneration(generation, undo);
+
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+    ignoreUndoCommands = true;
+
+    auto apply = [this, &cursor](int position, const QString& oldText, const QString& newText)
+    {
+        cursor.setPosition(position);
+        cursor.setPosition(position + oldText.size(), QTextCursor::KeepAnchor);
+        cursor.insertText(newText);
+        _shadowText.replace(position, oldText.size(), newText);
+    };
+
+    if (undo)
+    {
+        for (auto it = deltas.crbegin(); it != deltas.crend(); ++it)
+            apply(it->position, it->addedText, it->removedText);
+    }
+    else
     {
-        int totalChange = charsRemoved + charsAdded;
-        _editor.getUndoStack()->push(new CodeEditModeCommand(*this, lastUndoText, toPlainText(), totalChange));
+        for (const auto& delta : deltas)
+            apply(delta.position, delta.removedText, delta.addedText);
     }
 
-    lastUndoText = document()->toPlainText();
+    ignoreUndoCommands = false;
+    cursor.endEditBlock();
+
+    setTextCursor(cursor);
+}
+
+void CodeEditMode::slot_contentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // Deltas applied by us and full text replacements update the shadow text by themselves
+    if (ignoreUndoCommands) return;
+
+    // Qt may report the trailing paragraph separator that isn't a part of the plain text
+    const int docLength = document()->characterCount() - 1;
+    charsRemoved = std::max(0, std::min(charsRemoved, _shadowText.size() - position));
+    charsAdded = std::max(0, std::min(charsAdded, docLength - position));
+
+    QTextCursor cursor(document());
+    cursor.setPosition(position);
+    cursor.setPosition(position + charsAdded, QTextCursor::KeepAnchor);
+
+    CodeEditDelta delta;
+    delta.position = position;
+    delta.removedText = _shadowText.mid(position, charsRemoved);
+    delta.addedText = toPlainText(cursor.selectedText());
+
+    _shadowText.replace(position, charsRemoved, delta.addedText);
+
+    // Reported ranges may be wider than the actual change (e.g. for format changes), trim them
+    int prefix = 0;
+    const int maxPrefix = std::min(delta.removedText.size(), delta.addedText.size());
+    while (prefix < maxPrefix && delta.removedText[prefix] == delta.addedText[prefix]) ++prefix;
+
+    int suffix = 0;
+    const int maxSuffix = maxPrefix - prefix;
+    while (suffix < maxSuffix &&
+           delta.removedText[delta.removedText.size() - 1 - suffix] == delta.addedText[delta.addedText.size() - 1 - suffix])
+        ++suffix;
+
+    if (prefix + suffix == delta.removedText.size() && prefix + suffix == delta.addedText.size()) return;
+
+    delta.position += prefix;
+    delta.removedText = delta.removedText.mid(prefix, delta.removedText.size() - prefix - suffix);
+    delta.addedText = delta.addedText.mid(prefix, delta.addedText.size() - prefix - suffix);
+
+    _editor.getUndoStack()->push(new CodeEditModeCommand(*this, _generation, std::move(delta)));
 }
 
 //---------------------------------------------------------------------
@@ -144,25 +242,25 @@ bool ViewRestoringCodeEditMode::propagateToVisual()
 
 //---------------------------------------------------------------------
 
-CodeEditModeCommand::CodeEditModeCommand(CodeEditMode& owner, const QString& oldText, const QString& newText, int totalChange)
+CodeEditModeCommand::CodeEditModeCommand(CodeEditMode& owner, const std::shared_ptr<CodeEditGeneration>& generation, CodeEditDelta&& delta)
     : _owner(owner)
-    , _oldText(oldText)
-    , _newText(newText)
-    , _totalChange(totalChange)
+    , _generation(generation)
+    , _totalChange(delta.removedText.size() + delta.addedText.size())
 {
+    _deltas.push_back(std::move(delta));
     refreshText();
 }
 
 void CodeEditModeCommand::undo()
 {
     QUndoCommand::undo();
-    _owner.setCodeWithoutUndoHistory(_oldText);
+    _owner.applyDeltas(_generation, _deltas, true);
 }
 
 void CodeEditModeCommand::redo()
 {
     if (!_dryRun)
-        _owner.setCodeWithoutUndoHistory(_newText);
+        _owner.applyDeltas(_generation, _deltas, false);
 
     _dryRun = false;
 
@@ -174,17 +272,21 @@ int CodeEditModeCommand::id() const
     return 1000 + 1;
 }
 
-// FIXME: need compact undo/redo, not the whole text saving. See QTextEdit source code. For 1.x release?
 bool CodeEditModeCommand::mergeWith(const QUndoCommand* other)
 {
     const CodeEditModeCommand* otherCmd = dynamic_cast<const CodeEditModeCommand*>(other);
     assert(&_owner == &otherCmd->_owner);
 
+    // Deltas of different generations are applied to different texts
+    if (_generation != otherCmd->_generation) return false;
+
     // Slice changes by 64 chars for now, can change
     if (_totalChange + otherCmd->_totalChange < 64)
     {
         _totalChange += otherCmd->_totalChange;
-        _newText = otherCmd->_newText;
+        for (const auto& delta : otherCmd->_deltas)
+            if (!appendDelta(delta))
+                _deltas.push_back(delta);
 
         refreshText();
 
@@ -194,6 +296,51 @@ bool CodeEditModeCommand::mergeWith(const QUndoCommand* other)
     return false;
 }
 
+// Tries to coalesce the delta with the last one, returns false if they aren't adjacent
+bool CodeEditModeCommand::appendDelta(const CodeEditDelta& delta)
+{
+    if (_deltas.empty()) return false;
+
+    CodeEditDelta& last = _deltas.back();
+    const int lastEnd = last.position + last.addedText.size();
+
+    if (delta.removedText.isEmpty() && delta.position == lastEnd)
+    {
+        // Typing
+        last.addedText += delta.addedText;
+        return true;
+    }
+
+    if (!delta.addedText.isEmpty()) return false;
+
+    if (delta.position == lastEnd)
+    {
+        // Deleting forward
+        last.removedText += delta.removedText;
+        return true;
+    }
+
+    if (delta.position + delta.removedText.size() == lastEnd)
+    {
+        // Erasing backward, possibly beyond the text added by the last delta
+        const int erased = delta.removedText.size();
+        if (erased <= last.addedText.size())
+        {
+            last.addedText.chop(erased);
+        }
+        else
+        {
+            const int erasedBefore = erased - last.addedText.size();
+            last.removedText.prepend(delta.removedText.left(erasedBefore));
+            last.addedText.clear();
+            last.position -= erasedBefore;
+        }
+        return true;
+    }
+
+    return false;
+}
+
 void CodeEditModeCommand::refreshText()
 {
     if (_totalChange == 1)
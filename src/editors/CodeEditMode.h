@@ -3,6 +3,25 @@
 
 #include "src/editors/MultiModeEditor.h"
 #include "qtextedit.h"
+#include <memory>
+#include <vector>
+
+// A single change of the code, enough to apply or revert it
+struct CodeEditDelta
+{
+    int position = 0;
+    QString removedText;
+    QString addedText;
+};
+
+// Code is regenerated from the visual mode each time the code mode is activated, so deltas recorded
+// against the previous code can't be applied to the new one. Each regeneration starts a new generation,
+// and undo commands restore the text of their own generation before applying deltas.
+struct CodeEditGeneration
+{
+    QString baseText; // Text the generation started with
+    QString finalText; // Text when the generation was left
+};
 
 // This is the most used alternative editing mode that allows you to edit raw code.
 // Raw code is mostly XML in CEGUI formats but can be anything else in a generic sense.
@@ -28,6 +47,7 @@ public:
     virtual void refreshFromVisual();
     virtual bool propagateToVisual();
     void setCodeWithoutUndoHistory(const QString& code);
+    void applyDeltas(const std::shared_ptr<CodeEditGeneration>& generation, const std::vector<CodeEditDelta>& deltas, bool undo);
 
 protected slots:
 
@@ -35,8 +55,12 @@ protected slots:
 
 protected:
 
+    void enterGeneration(const std::shared_ptr<CodeEditGeneration>& generation, bool atEnd);
+    void setTextWithoutUndoHistory(const QString& text);
+
     bool ignoreUndoCommands = false;
-    QString lastUndoText;
+    QString _shadowText; // Mirrors the document to know what was removed by a change, updated by deltas
+    std::shared_ptr<CodeEditGeneration> _generation;
 };
 
 class ViewRestoringCodeEditMode : public CodeEditMode
@@ -55,14 +79,13 @@ protected:
     int lastCursorSelectionStart = 0;
 };
 
-// Undo command for code edit mode.
-// TODO: Extremely memory hungry implementation for now, I have to figure out how to use my own
-// QUndoStack with QTextDocument in the future to fix this.
+// Undo command for code edit mode. Stores only changed fragments of the text, consecutive
+// typing and erasing are coalesced into a single delta.
 class CodeEditModeCommand : public QUndoCommand
 {
 public:
 
-    CodeEditModeCommand(CodeEditMode& owner, const QString& oldText, const QString& newText, int totalChange);
+    CodeEditModeCommand(CodeEditMode& owner, const std::shared_ptr<CodeEditGeneration>& generation, CodeEditDelta&& delta);
 
     virtual void undo() override;
     virtual void redo() override;
@@ -73,9 +96,11 @@ public:
 
 protected:
 
+    bool appendDelta(const CodeEditDelta& delta);
+
     CodeEditMode& _owner;
-    QString _oldText;
-    QString _newText;
+    std::shared_ptr<CodeEditGeneration> _generation;
+    std::vector<CodeEditDelta> _deltas;
     int _totalChange;
     bool _dryRun = true;
 };
@@ -39,6 +39,11 @@ public:
     virtual void deactivate(MainWindow& mainWindow);
     virtual void saveState(QSettings& /*settings*/, const QString& /*rootPath*/) const {}
     virtual void restoreState(const QSettings& /*settings*/, const QString& /*rootPath*/) {}
+
+    // Project resources hot reload. Editor must destroy all its CEGUI objects in a release
+    // and recreate them in a restore. Editors not supporting it are reopened instead.
+    virtual bool releaseProjectResources() { return false; }
+    virtual void restoreProjectResources() {}
     void reloadData();
     void destroy();
 
@@ -421,8 +421,11 @@ void ImagesetDeleteCommand::undo()
 
 void ImagesetDeleteCommand::redo()
 {
+    std::vector<QString> names;
+    names.reserve(_imageRecords.size());
     for (auto& rec : _imageRecords)
-        _visualMode.getImagesetEntry()->removeImageEntry(rec.name);
+        names.push_back(rec.name);
+    _visualMode.getImagesetEntry()->removeImageEntries(names);
 
     _visualMode.getDockWidget()->refresh();
 
@@ -581,8 +584,11 @@ void ImagesetDuplicateCommand::undo()
 {
     QUndoCommand::undo();
 
+    std::vector<QString> names;
+    names.reserve(_imageRecords.size());
     for (auto& rec : _imageRecords)
-        _visualMode.getImagesetEntry()->removeImageEntry(rec.name);
+        names.push_back(rec.name);
+    _visualMode.getImagesetEntry()->removeImageEntries(names);
 
     _visualMode.getDockWidget()->refresh();
 }
@@ -620,8 +626,11 @@ void ImagesetPasteCommand::undo()
 {
     QUndoCommand::undo();
 
+    std::vector<QString> names;
+    names.reserve(_imageRecords.size());
     for (auto& rec : _imageRecords)
-        _visualMode.getImagesetEntry()->removeImageEntry(rec.name);
+        names.push_back(rec.name);
+    _visualMode.getImagesetEntry()->removeImageEntries(names);
 
     _visualMode.getDockWidget()->refresh();
 }
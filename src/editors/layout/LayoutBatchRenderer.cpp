@@ -0,0 +1,366 @@
+#include "src/editors/layout/LayoutBatchRenderer.h"
+#include "src/ui/CEGUIGraphicsScene.h"
+#include "src/cegui/CEGUIManager.h"
+#include "src/cegui/CEGUIProject.h"
+#include "src/cegui/CEGUIUtils.h"
+#include <CEGUI/Window.h>
+#include <CEGUI/WindowManager.h>
+#include <CEGUI/GUIContext.h>
+#include <CEGUI/FontManager.h>
+#include <qcommandlineparser.h>
+#include <qguiapplication.h>
+#include <qdiriterator.h>
+#include <qprocess.h>
+#include <qthread.h>
+#include <qimage.h>
+#include <qfile.h>
+#include <qtextstream.h>
+#include <qelapsedtimer.h>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+
+static void report(const QString& status, const QString& name, const QString& details = QString())
+{
+    QTextStream out(stdout);
+    out << status << " " << name;
+    if (!details.isEmpty()) out << ": " << details;
+    out << "\n";
+    out.flush();
+}
+
+// Returns a ratio of pixels differing more than by a tolerance in any channel. Differing pixels
+// are marked red over a faded golden image.
+static double compareImages(const QImage& image, const QImage& golden, int channelTolerance, QImage& outDiff)
+{
+    if (image.size() != golden.size() || golden.isNull())
+    {
+        outDiff = image;
+        return 1.0;
+    }
+
+    outDiff = QImage(golden.size(), QImage::Format_ARGB32);
+
+    qint64 diffCount = 0;
+    for (int y = 0; y < golden.height(); ++y)
+    {
+        auto imageLine = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        auto goldenLine = reinterpret_cast<const QRgb*>(golden.constScanLine(y));
+        auto diffLine = reinterpret_cast<QRgb*>(outDiff.scanLine(y));
+        for (int x = 0; x < golden.width(); ++x)
+        {
+            const QRgb a = imageLine[x];
+            const QRgb b = goldenLine[x];
+            if (std::abs(qRed(a) - qRed(b)) > channelTolerance ||
+                std::abs(qGreen(a) - qGreen(b)) > channelTolerance ||
+                std::abs(qBlue(a) - qBlue(b)) > channelTolerance ||
+                std::abs(qAlpha(a) - qAlpha(b)) > channelTolerance)
+            {
+                ++diffCount;
+                diffLine[x] = qRgba(255, 0, 0, 255);
+            }
+            else
+            {
+                const int gray = qGray(b);
+                diffLine[x] = qRgba(gray, gray, gray, qAlpha(b) / 4);
+            }
+        }
+    }
+
+    return static_cast<double>(diffCount) / (static_cast<double>(golden.width()) * golden.height());
+}
+
+void LayoutBatchRenderer::addCommandLineOptions(QCommandLineParser& cmdLine)
+{
+    cmdLine.addOptions(
+    {
+        { "renderProject", "Render layouts of the project offscreen without UI and exit.", "project" },
+        { "layout", "Layout file or directory with layouts to render. May be repeated.", "path" },
+        { "resolution", "Resolution to render at, e.g. 1280x720. May be repeated. Project default resolution if omitted.", "WxH" },
+        { "outputDir", "Directory for rendered images.", "dir" },
+        { "goldenDir", "Directory with golden images to compare rendered ones against.", "dir" },
+        { "diffThreshold", "Max ratio of differing pixels for an image to match golden one, 0 by default.", "ratio" },
+        { "channelTolerance", "Max colour channel difference for pixels to be considered equal, 0 by default.", "value" },
+        { "jobs", "Number of rendering processes, CPU core count by default.", "count" },
+    });
+}
+
+bool LayoutBatchRenderer::isRequested(const QCommandLineParser& cmdLine)
+{
+    return cmdLine.isSet("renderProject");
+}
+
+LayoutBatchRenderer::LayoutBatchRenderer(const QCommandLineParser& cmdLine)
+{
+    _argumentsValid = parseArguments(cmdLine);
+}
+
+bool LayoutBatchRenderer::parseArguments(const QCommandLineParser& cmdLine)
+{
+    _projectFile = QFileInfo(cmdLine.value("renderProject")).absoluteFilePath();
+    if (!QFileInfo(_projectFile).isFile())
+    {
+        report("FAIL", _projectFile, "project file not found");
+        return false;
+    }
+
+    if (!cmdLine.isSet("outputDir"))
+    {
+        report("FAIL", _projectFile, "output directory must be specified");
+        return false;
+    }
+
+    _outputDir = QDir(cmdLine.value("outputDir"));
+    _compare = cmdLine.isSet("goldenDir");
+    if (_compare) _goldenDir = QDir(cmdLine.value("goldenDir"));
+
+    for (const QString& resolution : cmdLine.values("resolution"))
+    {
+        const QStringList parts = resolution.toLower().split('x');
+        const int width = (parts.size() == 2) ? parts[0].toInt() : 0;
+        const int height = (parts.size() == 2) ? parts[1].toInt() : 0;
+        if (width <= 0 || height <= 0)
+        {
+            report("FAIL", resolution, "invalid resolution, WxH expected");
+            return false;
+        }
+
+        _resolutions.push_back(QSize(width, height));
+    }
+
+    _diffThreshold = cmdLine.value("diffThreshold").toDouble();
+    _channelTolerance = cmdLine.value("channelTolerance").toInt();
+    _jobCount = cmdLine.isSet("jobs") ? cmdLine.value("jobs").toInt() : QThread::idealThreadCount();
+
+    for (const QString& path : cmdLine.values("layout"))
+        collectLayouts(path);
+
+    // Layouts may be listed explicitly and found in a directory at the same time
+    _layouts.removeDuplicates();
+
+    return true;
+}
+
+void LayoutBatchRenderer::collectLayouts(const QString& path)
+{
+    QFileInfo info(path);
+    if (info.isDir())
+    {
+        QDirIterator it(info.absoluteFilePath(), { "*.layout" }, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+            _layouts.push_back(it.next());
+    }
+    else
+    {
+        // Missing files are reported as failures by a renderer
+        _layouts.push_back(info.absoluteFilePath());
+    }
+}
+
+int LayoutBatchRenderer::run()
+{
+    if (!_argumentsValid) return Error;
+
+    if (_layouts.empty())
+    {
+        report("FAIL", _projectFile, "no layouts to render");
+        return Error;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const int workerCount = std::min(_jobCount, _layouts.size());
+    const int result = (workerCount > 1) ? runWorkers(workerCount) : renderLayouts();
+
+    QTextStream(stdout) << QString("Rendered %1 layout(s) in %2 ms\n").arg(_layouts.size()).arg(timer.elapsed());
+
+    return result;
+}
+
+// Launches this executable in a single job mode for each share of layouts
+int LayoutBatchRenderer::runWorkers(int workerCount)
+{
+    // Round robin gives a better balance than slicing when layouts from the same directory have similar complexity
+    std::vector<QStringList> shares(static_cast<size_t>(workerCount));
+    for (int i = 0; i < _layouts.size(); ++i)
+        shares[static_cast<size_t>(i % workerCount)].push_back(_layouts[i]);
+
+    QStringList commonArgs;
+    commonArgs << "-platform" << QGuiApplication::platformName()
+               << "--renderProject" << _projectFile
+               << "--outputDir" << _outputDir.absolutePath()
+               << "--diffThreshold" << QString::number(_diffThreshold)
+               << "--channelTolerance" << QString::number(_channelTolerance)
+               << "--jobs" << "1";
+    if (_compare) commonArgs << "--goldenDir" << _goldenDir.absolutePath();
+    for (const QSize& resolution : _resolutions)
+        commonArgs << "--resolution" << QString("%1x%2").arg(resolution.width()).arg(resolution.height());
+
+    std::vector<std::unique_ptr<QProcess>> workers;
+    for (const QStringList& share : shares)
+    {
+        QStringList args = commonArgs;
+        for (const QString& layoutPath : share)
+            args << "--layout" << layoutPath;
+
+        auto worker = std::make_unique<QProcess>();
+        worker->setProcessChannelMode(QProcess::ForwardedChannels);
+        worker->start(QCoreApplication::applicationFilePath(), args);
+        workers.push_back(std::move(worker));
+    }
+
+    int result = Success;
+    for (auto& worker : workers)
+    {
+        // Don't limit time, there is no way to predict how long a share will take
+        if (!worker->waitForFinished(-1) || worker->exitStatus() != QProcess::NormalExit)
+        {
+            report("FAIL", worker->arguments().join(' '), "worker process crashed: " + worker->errorString());
+            result = Error;
+        }
+        else
+        {
+            result = std::max(result, worker->exitCode());
+        }
+    }
+
+    return result;
+}
+
+int LayoutBatchRenderer::renderLayouts()
+{
+    auto& ceguiManager = CEGUIManager::Instance();
+    ceguiManager.setInteractive(false);
+    if (!ceguiManager.loadProject(_projectFile))
+    {
+        report("FAIL", _projectFile, "can't load the project");
+        return Error;
+    }
+
+    auto project = ceguiManager.getCurrentProject();
+    _layoutsDir = QDir(project->getAbsolutePathOf(project->layoutsPath));
+    if (_resolutions.empty()) _resolutions.push_back(project->getDefaultResolution());
+
+    int result = Success;
+    {
+        CEGUIGraphicsScene scene(nullptr, _resolutions[0].width(), _resolutions[0].height());
+
+        // Unlike the editor we can't ask to create a font, so any existing one is used
+        auto context = scene.getCEGUIContext();
+        const auto& fontRegistry = CEGUI::FontManager::getSingleton().getRegisteredFonts();
+        if (!context->getDefaultFont() && !fontRegistry.empty())
+            context->setDefaultFont(fontRegistry.begin()->second);
+
+        for (const QString& layoutPath : _layouts)
+            result = std::max(result, renderLayout(scene, layoutPath));
+    }
+
+    ceguiManager.unloadProject();
+
+    return result;
+}
+
+// No time pulses are injected, so animations and caret blinking don't affect the result
+int LayoutBatchRenderer::renderLayout(CEGUIGraphicsScene& scene, const QString& layoutPath)
+{
+    QFile file(layoutPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        report("FAIL", layoutPath, "can't read the file");
+        return Error;
+    }
+
+    const QString rawData = file.readAll();
+
+    auto& ceguiManager = CEGUIManager::Instance();
+    auto context = scene.getCEGUIContext();
+
+    // Activate CEGUI OpenGL context for possible imagery cache FBOs creation
+    ceguiManager.makeOpenGLContextCurrent();
+
+    CEGUI::Window* rootWidget = nullptr;
+    try
+    {
+        rootWidget = CEGUI::WindowManager::getSingleton().loadLayoutFromString(CEGUIUtils::qStringToString(rawData));
+    }
+    catch (const std::exception& e)
+    {
+        ceguiManager.doneOpenGLContextCurrent();
+        report("FAIL", layoutPath, e.what());
+        return Error;
+    }
+
+    context->setRootWindow(rootWidget);
+    ceguiManager.doneOpenGLContextCurrent();
+
+    int result = Success;
+    for (const QSize& resolution : _resolutions)
+    {
+        scene.setCEGUIDisplaySize(resolution.width(), resolution.height());
+        const QImage image = scene.getCEGUIScreenshot().convertToFormat(QImage::Format_ARGB32);
+        result = std::max(result, processImage(image, getImageName(layoutPath, resolution)));
+    }
+
+    ceguiManager.makeOpenGLContextCurrent();
+    context->setRootWindow(nullptr);
+    CEGUI::WindowManager::getSingleton().destroyWindow(rootWidget);
+    CEGUI::WindowManager::getSingleton().cleanDeadPool();
+    ceguiManager.doneOpenGLContextCurrent();
+
+    return result;
+}
+
+int LayoutBatchRenderer::processImage(const QImage& image, const QString& imageName)
+{
+    const QString outputPath = _outputDir.filePath(imageName + ".png");
+    QDir().mkpath(QFileInfo(outputPath).absolutePath());
+    if (image.isNull() || !image.save(outputPath, "PNG"))
+    {
+        report("FAIL", imageName, "can't save " + outputPath);
+        return Error;
+    }
+
+    if (!_compare)
+    {
+        report("OK", imageName);
+        return Success;
+    }
+
+    const QString goldenPath = _goldenDir.filePath(imageName + ".png");
+    const QImage golden = QImage(goldenPath).convertToFormat(QImage::Format_ARGB32);
+    if (golden.isNull())
+    {
+        report("MISSING", imageName, "no golden image " + goldenPath);
+        return ImagesDiffer;
+    }
+
+    QImage diff;
+    const double diffRatio = compareImages(image, golden, _channelTolerance, diff);
+    const QString details = (image.size() != golden.size()) ?
+                QString("size %1x%2 differs from golden").arg(image.width()).arg(image.height()) :
+                QString("%1% pixels differ").arg(diffRatio * 100.0, 0, 'f', 3);
+
+    if (diffRatio <= _diffThreshold)
+    {
+        report("OK", imageName, details);
+        return Success;
+    }
+
+    diff.save(_outputDir.filePath(imageName + ".diff.png"), "PNG");
+    report("DIFF", imageName, details);
+    return ImagesDiffer;
+}
+
+// Layouts from the project layouts directory keep their subdirectories, others are named by file name
+QString LayoutBatchRenderer::getImageName(const QString& layoutPath, const QSize& resolution) const
+{
+    const QFileInfo info(layoutPath);
+    QString name = _layoutsDir.relativeFilePath(info.absoluteFilePath());
+    if (name.startsWith("..") || QDir::isAbsolutePath(name))
+        name = info.fileName();
+
+    if (name.endsWith(".layout")) name.chop(7);
+
+    return QString("%1-%2x%3").arg(name).arg(resolution.width()).arg(resolution.height());
+}
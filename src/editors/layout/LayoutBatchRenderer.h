@@ -0,0 +1,63 @@
+#ifndef LAYOUTBATCHRENDERER_H
+#define LAYOUTBATCHRENDERER_H
+
+#include <qstringlist.h>
+#include <qsize.h>
+#include <qdir.h>
+#include <vector>
+
+// Renders layouts offscreen into PNG files without any UI, e.g. for screenshot regression testing in CI.
+// Images may be compared against golden ones with a per-pixel tolerance. Layouts are distributed between
+// worker processes of the same executable, each of them loads the project only once. Example:
+//
+// ceed -platform offscreen --renderProject my.ceed --layout layouts_dir --layout other.layout
+//      --resolution 1280x720 --resolution 1920x1080 --outputDir out --goldenDir golden --jobs 8
+//
+// Exit code is 0 if all images match, 1 if any of them differs or has no golden image, 2 on errors.
+
+class QCommandLineParser;
+class QImage;
+class CEGUIGraphicsScene;
+
+class LayoutBatchRenderer
+{
+public:
+
+    enum ExitCode
+    {
+        Success = 0,
+        ImagesDiffer = 1,
+        Error = 2
+    };
+
+    static void addCommandLineOptions(QCommandLineParser& cmdLine);
+    static bool isRequested(const QCommandLineParser& cmdLine);
+
+    LayoutBatchRenderer(const QCommandLineParser& cmdLine);
+
+    int run();
+
+protected:
+
+    bool parseArguments(const QCommandLineParser& cmdLine);
+    void collectLayouts(const QString& path);
+    int runWorkers(int workerCount);
+    int renderLayouts();
+    int renderLayout(CEGUIGraphicsScene& scene, const QString& layoutPath);
+    int processImage(const QImage& image, const QString& imageName);
+    QString getImageName(const QString& layoutPath, const QSize& resolution) const;
+
+    QString _projectFile;
+    QDir _outputDir;
+    QDir _goldenDir;
+    QDir _layoutsDir; // Image names repeat the layout path relative to it
+    QStringList _layouts; // Absolute paths
+    std::vector<QSize> _resolutions;
+    double _diffThreshold = 0.0; // Max allowed ratio of differing pixels
+    int _channelTolerance = 0; // Max colour channel difference of pixels considered equal
+    int _jobCount = 1;
+    bool _compare = false;
+    bool _argumentsValid = false;
+};
+
+#endif // LAYOUTBATCHRENDERER_H
@@ -0,0 +1,443 @@
+#include "src/editors/layout/LayoutBenchmark.h"
+#include "src/editors/layout/LayoutEditor.h"
+#include "src/editors/layout/LayoutVisualMode.h"
+#include "src/editors/layout/LayoutUndoCommands.h"
+#include "src/ui/layout/LayoutScene.h"
+#include "src/ui/layout/LayoutManipulator.h"
+#include "src/ui/layout/WidgetHierarchyDockWidget.h"
+#include "src/cegui/CEGUIManager.h"
+#include "src/cegui/CEGUIUtils.h"
+#include <CEGUI/WindowManager.h>
+#include <CEGUI/widgets/TabControl.h>
+#include <qcommandlineparser.h>
+#include <qcoreapplication.h>
+#include <qtemporarydir.h>
+#include <qfile.h>
+#include <qtextstream.h>
+#include <qelapsedtimer.h>
+#include <qdatetime.h>
+#include <qjsonarray.h>
+#include <qjsondocument.h>
+#include <qundostack.h>
+#include <memory>
+#include <algorithm>
+#include <cassert>
+
+static const int DeepChainLength = 64;
+static const int GridColumns = 100;
+
+static void report(const QString& status, const QString& name, const QString& details = QString())
+{
+    QTextStream out(stdout);
+    out << status << " " << name;
+    if (!details.isEmpty()) out << ": " << details;
+    out << "\n";
+    out.flush();
+}
+
+static void placeWidget(CEGUI::Window* widget, float x, float y, float width, float height)
+{
+    widget->setPosition(CEGUI::UVector2(CEGUI::UDim(0.f, x), CEGUI::UDim(0.f, y)));
+    widget->setSize(CEGUI::USize(CEGUI::UDim(0.f, width), CEGUI::UDim(0.f, height)));
+}
+
+static QJsonObject getStats(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+
+    QJsonObject stats;
+    stats["min_ms"] = samples.front();
+    stats["median_ms"] = samples[samples.size() / 2];
+    stats["max_ms"] = samples.back();
+    return stats;
+}
+
+void LayoutBenchmark::addCommandLineOptions(QCommandLineParser& cmdLine)
+{
+    cmdLine.addOptions(
+    {
+        { "benchmarkProject", "Measure layout editor performance on synthetic layouts without UI and exit.", "project" },
+        { "benchmarkOutput", "JSON file for benchmark results.", "file" },
+        { "benchmarkSize", "Widget count of generated layouts. May be repeated. 1000, 10000 and 50000 by default.", "count" },
+        { "benchmarkRepeat", "Number of measurements of each layout, 3 by default.", "count" },
+        { "benchmarkSkin", "Skin of generated widgets, the first skin with a TabControl by default.", "skin" },
+        { "benchmarkLayoutsDir", "Directory to keep generated layouts in, they are deleted if omitted.", "dir" },
+    });
+}
+
+bool LayoutBenchmark::isRequested(const QCommandLineParser& cmdLine)
+{
+    return cmdLine.isSet("benchmarkProject");
+}
+
+LayoutBenchmark::LayoutBenchmark(const QCommandLineParser& cmdLine)
+{
+    _argumentsValid = parseArguments(cmdLine);
+}
+
+bool LayoutBenchmark::parseArguments(const QCommandLineParser& cmdLine)
+{
+    _projectFile = QFileInfo(cmdLine.value("benchmarkProject")).absoluteFilePath();
+    if (!QFileInfo(_projectFile).isFile())
+    {
+        report("FAIL", _projectFile, "project file not found");
+        return false;
+    }
+
+    if (!cmdLine.isSet("benchmarkOutput"))
+    {
+        report("FAIL", _projectFile, "output file must be specified");
+        return false;
+    }
+
+    _outputFile = cmdLine.value("benchmarkOutput");
+    _layoutsDir = cmdLine.value("benchmarkLayoutsDir");
+    _skin = cmdLine.value("benchmarkSkin");
+
+    if (cmdLine.isSet("benchmarkRepeat"))
+    {
+        _repeatCount = cmdLine.value("benchmarkRepeat").toInt();
+        if (_repeatCount <= 0)
+        {
+            report("FAIL", cmdLine.value("benchmarkRepeat"), "invalid repeat count");
+            return false;
+        }
+    }
+
+    for (const QString& size : cmdLine.values("benchmarkSize"))
+    {
+        const int widgetCount = size.toInt();
+        if (widgetCount <= 1)
+        {
+            report("FAIL", size, "invalid widget count");
+            return false;
+        }
+
+        _sizes.push_back(widgetCount);
+    }
+
+    if (_sizes.empty()) _sizes = { 1000, 10000, 50000 };
+
+    return true;
+}
+
+int LayoutBenchmark::run()
+{
+    if (!_argumentsValid) return Error;
+
+    auto& ceguiManager = CEGUIManager::Instance();
+    ceguiManager.setInteractive(false);
+    if (!ceguiManager.loadProject(_projectFile))
+    {
+        report("FAIL", _projectFile, "can't load the project");
+        return Error;
+    }
+
+    detectWidgetTypes();
+
+    QTemporaryDir tempDir;
+    const QDir layoutsDir(_layoutsDir.isEmpty() ? tempDir.path() : _layoutsDir);
+    QDir().mkpath(layoutsDir.absolutePath());
+
+    int result = Success;
+    QJsonArray cases;
+    for (const QString shape : { "wide", "deep", "containers", "tabs" })
+    {
+        if (shape == "tabs" && _tabControlType.isEmpty())
+        {
+            report("SKIP", shape, "no TabControl in the skin '" + _skin + "'");
+            continue;
+        }
+
+        for (int widgetCount : _sizes)
+        {
+            QJsonObject caseResult;
+            if (runCase(shape, widgetCount, layoutsDir, caseResult))
+                cases.append(caseResult);
+            else
+                result = Error;
+        }
+    }
+
+    ceguiManager.unloadProject();
+
+    QJsonObject root;
+    root["ceed"] = QCoreApplication::applicationVersion();
+    root["project"] = _projectFile;
+    root["skin"] = _skin;
+    root["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["repeat"] = _repeatCount;
+    root["cases"] = cases;
+
+    QFile file(_outputFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(QJsonDocument(root).toJson()) < 0)
+    {
+        report("FAIL", _outputFile, "can't write results");
+        return Error;
+    }
+
+    return result;
+}
+
+// Generated widgets must have some visual to make rendering and imagery caching a part of the measurement
+void LayoutBenchmark::detectWidgetTypes()
+{
+    std::map<QString, QStringList> widgetsBySkin;
+    CEGUIManager::Instance().getAvailableWidgetsBySkin(widgetsBySkin);
+
+    if (_skin.isEmpty())
+    {
+        for (const auto& pair : widgetsBySkin)
+        {
+            if (pair.first != "__no_skin__" && pair.second.contains("TabControl"))
+            {
+                _skin = pair.first;
+                break;
+            }
+        }
+    }
+
+    auto it = widgetsBySkin.find(_skin);
+    if (it != widgetsBySkin.end())
+    {
+        if (it->second.contains("Button")) _leafType = _skin + "/Button";
+        if (it->second.contains("TabControl")) _tabControlType = _skin + "/TabControl";
+    }
+
+    if (_leafType.isEmpty()) _leafType = "DefaultWindow";
+}
+
+CEGUI::Window* LayoutBenchmark::createWidget(const QString& type, int& counter)
+{
+    ++counter;
+    return CEGUI::WindowManager::getSingleton().createWindow(CEGUIUtils::qStringToString(type),
+                                                             CEGUIUtils::qStringToString(QString("W%1").arg(counter)));
+}
+
+// Generates the layout through CEGUI to get exactly the format the editor saves. Counts only widgets
+// created explicitly, auto widgets of tab controls are not counted.
+QString LayoutBenchmark::generateLayout(const QString& shape, int widgetCount, int& outActualCount)
+{
+    int count = 0;
+    CEGUI::Window* root = createWidget("DefaultWindow", count);
+    root->setSize(CEGUI::USize(CEGUI::UDim(1.f, 0.f), CEGUI::UDim(1.f, 0.f)));
+
+    for (int block = 0; count < widgetCount; ++block)
+    {
+        const float blockX = static_cast<float>(block % GridColumns) * 20.f;
+        const float blockY = static_cast<float>(block / GridColumns) * 20.f;
+
+        if (shape == "wide")
+        {
+            CEGUI::Window* widget = createWidget(_leafType, count);
+            placeWidget(widget, blockX, blockY, 18.f, 18.f);
+            root->addChild(widget);
+        }
+        else if (shape == "deep")
+        {
+            CEGUI::Window* parent = root;
+            for (int depth = 0; depth < DeepChainLength && count < widgetCount; ++depth)
+            {
+                CEGUI::Window* widget = createWidget(_leafType, count);
+                if (depth)
+                {
+                    widget->setPosition(CEGUI::UVector2(CEGUI::UDim(0.f, 1.f), CEGUI::UDim(0.f, 1.f)));
+                    widget->setSize(CEGUI::USize(CEGUI::UDim(1.f, -2.f), CEGUI::UDim(1.f, -2.f)));
+                }
+                else
+                {
+                    placeWidget(widget, blockX, blockY, 200.f, 200.f);
+                }
+                parent->addChild(widget);
+                parent = widget;
+            }
+        }
+        else if (shape == "containers")
+        {
+            CEGUI::Window* vertical = createWidget("VerticalLayoutContainer", count);
+            placeWidget(vertical, blockX, blockY, 0.f, 0.f);
+            root->addChild(vertical);
+            for (int row = 0; row < 10 && count < widgetCount; ++row)
+            {
+                CEGUI::Window* horizontal = createWidget("HorizontalLayoutContainer", count);
+                vertical->addChild(horizontal);
+                for (int column = 0; column < 8 && count < widgetCount; ++column)
+                {
+                    CEGUI::Window* widget = createWidget(_leafType, count);
+                    placeWidget(widget, 0.f, 0.f, 40.f, 20.f);
+                    horizontal->addChild(widget);
+                }
+            }
+        }
+        else if (shape == "tabs")
+        {
+            auto tabControl = dynamic_cast<CEGUI::TabControl*>(createWidget(_tabControlType, count));
+            assert(tabControl);
+            placeWidget(tabControl, blockX, blockY, 400.f, 300.f);
+            root->addChild(tabControl);
+            for (int page = 0; page < 4 && count < widgetCount; ++page)
+            {
+                CEGUI::Window* content = createWidget("DefaultWindow", count);
+                content->setText(CEGUIUtils::qStringToString(QString("Page %1").arg(page)));
+                content->setSize(CEGUI::USize(CEGUI::UDim(1.f, 0.f), CEGUI::UDim(1.f, 0.f)));
+                tabControl->addTab(content);
+                for (int i = 0; i < 24 && count < widgetCount; ++i)
+                {
+                    CEGUI::Window* widget = createWidget(_leafType, count);
+                    placeWidget(widget, static_cast<float>(i % 6) * 60.f, static_cast<float>(i / 6) * 25.f, 55.f, 20.f);
+                    content->addChild(widget);
+                }
+            }
+        }
+    }
+
+    outActualCount = count;
+
+    const QString rawData = CEGUIUtils::stringToQString(CEGUI::WindowManager::getSingleton().getLayoutAsString(*root));
+    CEGUI::WindowManager::getSingleton().destroyWindow(root);
+    CEGUI::WindowManager::getSingleton().cleanDeadPool();
+    return rawData;
+}
+
+bool LayoutBenchmark::runCase(const QString& shape, int widgetCount, const QDir& layoutsDir, QJsonObject& outResult)
+{
+    const QString name = QString("%1-%2").arg(shape).arg(widgetCount);
+
+    int actualCount = 0;
+    QString rawData;
+    try
+    {
+        rawData = generateLayout(shape, widgetCount, actualCount);
+    }
+    catch (const std::exception& e)
+    {
+        report("FAIL", name, QString("can't generate the layout: ") + e.what());
+        return false;
+    }
+
+    const QString layoutPath = layoutsDir.filePath(name + ".layout");
+    QFile file(layoutPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) || file.write(rawData.toUtf8()) < 0)
+    {
+        report("FAIL", layoutPath, "can't write the layout");
+        return false;
+    }
+    file.close();
+
+    Samples samples;
+    for (int i = 0; i < _repeatCount; ++i)
+    {
+        if (!measureEditor(layoutPath, rawData, samples))
+        {
+            report("FAIL", name, "the layout editor can't load the layout");
+            return false;
+        }
+    }
+
+    QJsonObject metrics;
+    for (const auto& pair : samples)
+        metrics[pair.first] = getStats(pair.second);
+
+    outResult["name"] = name;
+    outResult["shape"] = shape;
+    outResult["widgets"] = actualCount;
+    outResult["layoutBytes"] = static_cast<qint64>(file.size());
+    outResult["metrics"] = metrics;
+
+    report("OK", name, QString("open %1 ms (median)").arg(metrics["open"].toObject()["median_ms"].toDouble(), 0, 'f', 1));
+    return true;
+}
+
+// Opens the layout as the main window does, then repeats the steps of LayoutEditor::loadVisualFromString
+// one by one to see which of them dominates, and finally saves and moves all top level widgets
+bool LayoutBenchmark::measureEditor(const QString& layoutPath, const QString& rawData, Samples& samples)
+{
+    QElapsedTimer timer;
+    auto elapsedMs = [&timer]() { return static_cast<double>(timer.nsecsElapsed()) / 1000000.0; };
+
+    auto editor = std::make_unique<LayoutEditor>(layoutPath);
+
+    timer.start();
+    editor->initialize();
+    samples["open"].push_back(elapsedMs());
+
+    auto visualMode = editor->getVisualMode();
+    bool result = (visualMode->getRootWidget() != nullptr);
+    if (result)
+    {
+        try
+        {
+            timer.start();
+            visualMode->setRootWidgetManipulator(nullptr);
+            samples["close"].push_back(elapsedMs());
+
+            timer.start();
+            CEGUI::Window* widget = CEGUI::WindowManager::getSingleton().loadLayoutFromString(CEGUIUtils::qStringToString(rawData));
+            samples["parse"].push_back(elapsedMs());
+
+            timer.start();
+            auto root = new LayoutManipulator(*visualMode, nullptr, widget);
+            root->updateFromWidget();
+            root->createChildManipulators(true, false, false);
+            samples["create_manipulators"].push_back(elapsedMs());
+
+            timer.start();
+            visualMode->setRootWidgetManipulator(root);
+            samples["set_root"].push_back(elapsedMs());
+
+            // The same root would be synchronized incrementally with nothing to do, force a full rebuild
+            auto hierarchyDockWidget = visualMode->getHierarchyDockWidget();
+            hierarchyDockWidget->setRootWidgetManipulator(nullptr);
+            timer.start();
+            hierarchyDockWidget->setRootWidgetManipulator(root);
+            samples["hierarchy_rebuild"].push_back(elapsedMs());
+
+            QByteArray savedData;
+            timer.start();
+            editor->getRawData(savedData);
+            samples["save"].push_back(elapsedMs());
+
+            std::vector<LayoutMoveCommand::Record> records;
+            root->forEachChildWidget([&records](CEGUI::Window* child)
+            {
+                const CEGUI::UVector2 pos = child->getPosition();
+                records.push_back({ CEGUIUtils::stringToQString(child->getNamePath()), pos,
+                                    pos + CEGUI::UVector2(CEGUI::UDim(0.f, 10.f), CEGUI::UDim(0.f, 10.f)) });
+            });
+
+            // Geometry updates are deferred by the scene, flush them to measure the whole operation
+            auto scene = visualMode->getScene();
+            auto undoStack = editor->getUndoStack();
+
+            timer.start();
+            undoStack->push(new LayoutMoveCommand(*visualMode, std::move(records)));
+            scene->flushGeometryUpdates();
+            samples["move"].push_back(elapsedMs());
+
+            timer.start();
+            undoStack->undo();
+            scene->flushGeometryUpdates();
+            samples["move_undo"].push_back(elapsedMs());
+
+            timer.start();
+            undoStack->redo();
+            scene->flushGeometryUpdates();
+            samples["move_redo"].push_back(elapsedMs());
+        }
+        catch (const std::exception& e)
+        {
+            report("FAIL", layoutPath, e.what());
+            result = false;
+        }
+    }
+
+    editor->finalize();
+    editor->destroy();
+    editor.reset();
+
+    // Deferred work of the closed editor must not get into the next measurement
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    QCoreApplication::processEvents();
+
+    return result;
+}
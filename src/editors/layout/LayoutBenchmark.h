@@ -0,0 +1,68 @@
+#ifndef LAYOUTBENCHMARK_H
+#define LAYOUTBENCHMARK_H
+
+#include <qstring.h>
+#include <qjsonobject.h>
+#include <qdir.h>
+#include <map>
+#include <vector>
+
+// Measures layout editor open, save and undo/redo times on synthetic large layouts and writes results
+// as JSON, so that regressions are noticed by comparing runs. Layouts are generated with widgets of the
+// project skin in several shapes: wide (all widgets under the root), deep (long chains of nested widgets),
+// nested layout containers and tab controls. Real editors are created, but the main window is never shown.
+// Example:
+//
+// ceed -platform offscreen --benchmarkProject my.ceed --benchmarkOutput results.json
+//      --benchmarkSize 1000 --benchmarkSize 10000 --benchmarkRepeat 5
+//
+// Exit code is 0 on success and 2 on errors.
+
+class QCommandLineParser;
+class LayoutEditor;
+
+namespace CEGUI
+{
+    class Window;
+}
+
+class LayoutBenchmark
+{
+public:
+
+    enum ExitCode
+    {
+        Success = 0,
+        Error = 2
+    };
+
+    static void addCommandLineOptions(QCommandLineParser& cmdLine);
+    static bool isRequested(const QCommandLineParser& cmdLine);
+
+    LayoutBenchmark(const QCommandLineParser& cmdLine);
+
+    int run();
+
+protected:
+
+    using Samples = std::map<QString, std::vector<double>>; // Milliseconds by metric name
+
+    bool parseArguments(const QCommandLineParser& cmdLine);
+    void detectWidgetTypes();
+    QString generateLayout(const QString& shape, int widgetCount, int& outActualCount);
+    CEGUI::Window* createWidget(const QString& type, int& counter);
+    bool runCase(const QString& shape, int widgetCount, const QDir& layoutsDir, QJsonObject& outResult);
+    bool measureEditor(const QString& layoutPath, const QString& rawData, Samples& samples);
+
+    QString _projectFile;
+    QString _outputFile;
+    QString _layoutsDir; // Generated layouts are kept there if specified
+    QString _skin;
+    QString _leafType;
+    QString _tabControlType;
+    std::vector<int> _sizes;
+    int _repeatCount = 3;
+    bool _argumentsValid = false;
+};
+
+#endif // LAYOUTBENCHMARK_H
@@ -2,11 +2,14 @@
 #include "src/editors/layout/LayoutVisualMode.h"
 #include "src/editors/layout/LayoutEditor.h"
 #include "src/cegui/CEGUIUtils.h"
+#include "src/ui/XMLSyntaxHighlighter.h"
 #include <CEGUI/WindowManager.h>
 
 LayoutCodeMode::LayoutCodeMode(LayoutEditor& editor)
     : ViewRestoringCodeEditMode(editor)
 {
+    setAcceptRichText(false);
+    highlighter = new XMLSyntaxHighlighter(this);
 }
 
 QString LayoutCodeMode::getNativeCode()
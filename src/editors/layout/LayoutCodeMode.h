@@ -4,6 +4,7 @@
 #include "src/editors/CodeEditMode.h"
 
 class LayoutEditor;
+class XMLSyntaxHighlighter;
 
 class LayoutCodeMode : public ViewRestoringCodeEditMode
 {
@@ -13,6 +14,10 @@ public:
 
     virtual QString getNativeCode() override;
     virtual bool propagateNativeCode(const QString& code) override;
+
+protected:
+
+    XMLSyntaxHighlighter* highlighter = nullptr;
 };
 
 #endif // LAYOUTCODEMODE_H
@@ -14,6 +14,7 @@
 #include "src/ui/layout/WidgetHierarchyDockWidget.h"
 #include "src/ui/layout/CreateWidgetDockWidget.h"
 #include "src/ui/layout/LayoutManipulator.h"
+#include "src/ui/layout/LayoutScene.h"
 #include "src/Application.h"
 #include <qmenu.h>
 #include <qtoolbar.h>
@@ -57,8 +58,10 @@ bool LayoutEditor::loadVisualFromString(const QString& rawData)
             CEGUI::Window* widget = CEGUI::WindowManager::getSingleton().loadLayoutFromString(CEGUIUtils::qStringToString(rawData));
             auto root = new LayoutManipulator(*visualMode, nullptr, widget);
             root->updateFromWidget();
-            root->createChildManipulators(true, false, false);
             visualMode->setRootWidgetManipulator(root);
+
+            // Huge layouts become editable before all their manipulators are created
+            visualMode->getScene()->buildChildManipulatorsProgressively(root);
         }
         catch (const std::exception& e)
         {
@@ -149,6 +152,51 @@ void LayoutEditor::restoreState(const QSettings& settings, const QString& rootPa
     }
 }
 
+bool LayoutEditor::releaseProjectResources()
+{
+    // Live preview holds its own copy of widgets
+    if (dynamic_cast<LayoutPreviewerMode*>(tabs.currentWidget())) return false;
+
+    _releasedLayout.clear();
+    _releasedSelection.clear();
+
+    // Remember the current state, including unsaved changes
+    if (auto currentRootWidget = visualMode->getRootWidget())
+    {
+        _releasedLayout = CEGUIUtils::stringToQString(CEGUI::WindowManager::getSingleton().getLayoutAsString(*currentRootWidget));
+
+        std::set<LayoutManipulator*> selectedWidgets;
+        visualMode->getScene()->collectSelectedWidgets(selectedWidgets);
+        for (LayoutManipulator* manipulator : selectedWidgets)
+            _releasedSelection.insert(manipulator->getWidgetPath());
+    }
+
+    if (auto view = visualMode->getView())
+        _releasedSceneOffset = QPoint(view->horizontalScrollBar()->value(), view->verticalScrollBar()->value());
+
+    visualMode->setRootWidgetManipulator(nullptr);
+
+    return true;
+}
+
+void LayoutEditor::restoreProjectResources()
+{
+    loadVisualFromString(_releasedLayout);
+    visualMode->getScene()->selectWidgetsByPaths(_releasedSelection);
+
+    if (auto view = visualMode->getView())
+    {
+        view->horizontalScrollBar()->setValue(_releasedSceneOffset.x());
+        view->verticalScrollBar()->setValue(_releasedSceneOffset.y());
+    }
+
+    // Widget previews might have changed
+    visualMode->getCreateWidgetDockWidget()->populate();
+
+    _releasedLayout.clear();
+    _releasedSelection.clear();
+}
+
 void LayoutEditor::copy()
 {
     if (tabs.currentWidget() == visualMode)
@@ -244,7 +292,7 @@ void LayoutEditor::createSettings(Settings& mgr)
     secVisual->addEntry(std::move(entry));
 
     entry.reset(new SettingsEntry(*secVisual, "prevent_manipulator_overlap", false, "Prevent manipulator overlap",
-                                  "Only enable if you have a very fast computer and only edit small layouts. Very performance intensive!",
+                                  "Clips widget outlines overlapped by widgets stacked above them. May slow down editing of huge layouts.",
                                   "checkbox", false, 0));
     secVisual->addEntry(std::move(entry));
 
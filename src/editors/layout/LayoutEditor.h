@@ -2,6 +2,7 @@
 #define LAYOUTEDITOR_H
 
 #include "src/editors/MultiModeEditor.h"
+#include <set>
 
 // Binds all layout editing functionality together
 
@@ -12,6 +13,8 @@ class LayoutCodeMode;
 
 class LayoutEditor : public MultiModeEditor
 {
+    friend class LayoutBenchmark;
+
 public:
 
     static void createSettings(Settings& mgr);
@@ -27,6 +30,8 @@ public:
     virtual void deactivate(MainWindow& mainWindow) override;
     virtual void saveState(QSettings& settings, const QString& rootPath) const override;
     virtual void restoreState(const QSettings& settings, const QString& rootPath) override;
+    virtual bool releaseProjectResources() override;
+    virtual void restoreProjectResources() override;
 
     // Application commands implementation
     virtual void copy() override;
@@ -55,6 +60,11 @@ protected:
 
     LayoutVisualMode* visualMode = nullptr;
     LayoutCodeMode* codeMode = nullptr;
+
+    // Layout state saved for the time of project resources reload
+    QString _releasedLayout;
+    std::set<QString> _releasedSelection;
+    QPoint _releasedSceneOffset;
 };
 
 class LayoutEditorFactory : public EditorFactoryBase
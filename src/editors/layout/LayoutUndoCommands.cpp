@@ -5,6 +5,7 @@
 #include "src/ui/layout/WidgetHierarchyDockWidget.h"
 #include "src/ui/layout/WidgetHierarchyItem.h"
 #include "src/cegui/CEGUIUtils.h"
+#include "src/cegui/CEGUIWidgetSerializer.h"
 #include <CEGUI/widgets/GridLayoutContainer.h>
 #include <CEGUI/WindowManager.h>
 #include <CEGUI/CoordConverter.h>
@@ -12,14 +13,14 @@
 #include <qmessagebox.h>
 #include <qtimer.h>
 
-static LayoutManipulator* CreateManipulatorFromDataStream(LayoutVisualMode& visualMode, LayoutManipulator* parent,
-                                                          QDataStream& stream, size_t index = std::numeric_limits<size_t>().max())
+static LayoutManipulator* CreateManipulatorFromSerializedData(LayoutVisualMode& visualMode, LayoutManipulator* parent,
+                                                              CEGUIWidgetSerializer& reader, size_t index = std::numeric_limits<size_t>().max())
 {
     LayoutManipulator* manipulator;
 
     if (parent)
     {
-        CEGUI::Window* widget = CEGUIUtils::deserializeWidget(stream, parent->getWidget(), index);
+        CEGUI::Window* widget = reader.deserialize(parent->getWidget(), index);
         assert(widget);
         if (!widget) return nullptr;
 
@@ -35,7 +36,7 @@ static LayoutManipulator* CreateManipulatorFromDataStream(LayoutVisualMode& visu
     else
     {
         // No parent, root widget
-        CEGUI::Window* widget = CEGUIUtils::deserializeWidget(stream, nullptr);
+        CEGUI::Window* widget = reader.deserialize(nullptr);
         assert(widget);
         if (!widget) return nullptr;
 
@@ -69,7 +70,7 @@ void LayoutMoveCommand::undo()
         auto manipulator = _visualMode.getScene()->getManipulatorByPath(rec.path);
         assert(manipulator);
         manipulator->getWidget()->setPosition(rec.oldPos);
-        manipulator->updateFromWidget(false, true);
+        _visualMode.getScene()->scheduleGeometryUpdate(manipulator);
 
         // In case the pixel position didn't change but the absolute and negative components changed and canceled each other out
         manipulator->update();
@@ -85,7 +86,7 @@ void LayoutMoveCommand::redo()
         auto manipulator = _visualMode.getScene()->getManipulatorByPath(rec.path);
         assert(manipulator);
         manipulator->getWidget()->setPosition(rec.newPos);
-        manipulator->updateFromWidget(false, true);
+        _visualMode.getScene()->scheduleGeometryUpdate(manipulator);
 
         // In case the pixel position didn't change but the absolute and negative components changed and canceled each other out
         manipulator->update();
@@ -149,7 +150,7 @@ void LayoutResizeCommand::undo()
         auto manipulator = _visualMode.getScene()->getManipulatorByPath(rec.path);
         assert(manipulator);
         CEGUIUtils::setWidgetArea(manipulator->getWidget(), rec.oldPos, rec.oldSize);
-        manipulator->updateFromWidget(false, true);
+        _visualMode.getScene()->scheduleGeometryUpdate(manipulator);
 
         // In case the pixel position didn't change but the absolute and negative components changed and canceled each other out
         manipulator->update();
@@ -165,7 +166,7 @@ void LayoutResizeCommand::redo()
         auto manipulator = _visualMode.getScene()->getManipulatorByPath(rec.path);
         assert(manipulator);
         CEGUIUtils::setWidgetArea(manipulator->getWidget(), rec.newPos, rec.newSize);
-        manipulator->updateFromWidget(false, true);
+        _visualMode.getScene()->scheduleGeometryUpdate(manipulator);
 
         // In case the pixel position didn't change but the absolute and negative components changed and canceled each other out
         manipulator->update();
@@ -230,8 +231,7 @@ LayoutDeleteCommand::LayoutDeleteCommand(LayoutVisualMode& visualMode, QStringLi
         rec.indexInParent = manipulator->getWidgetIndexInParent();
 
         // Serialize deleted hierarchy for undo
-        QDataStream stream(&rec.data, QIODevice::WriteOnly);
-        CEGUIUtils::serializeWidget(*manipulator->getWidget(), stream, true);
+        rec.data = CEGUIWidgetSerializer::serialize({ manipulator->getWidget() });
 
         _records.push_back(std::move(rec));
     }
@@ -250,6 +250,8 @@ LayoutDeleteCommand::LayoutDeleteCommand(LayoutVisualMode& visualMode, QStringLi
 
 void LayoutDeleteCommand::undo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     QUndoCommand::undo();
 
     for (auto& rec : _records)
@@ -257,8 +259,8 @@ void LayoutDeleteCommand::undo()
         const int sepPos = rec.path.lastIndexOf('/');
         LayoutManipulator* parent = (sepPos < 0) ? nullptr : _visualMode.getScene()->getManipulatorByPath(rec.path.left(sepPos));
 
-        QDataStream stream(&rec.data, QIODevice::ReadOnly);
-        CreateManipulatorFromDataStream(_visualMode, parent, stream, rec.indexInParent);
+        CEGUIWidgetSerializer reader(rec.data);
+        CreateManipulatorFromSerializedData(_visualMode, parent, reader, rec.indexInParent);
     }
 
     _visualMode.getHierarchyDockWidget()->refresh();
@@ -266,6 +268,8 @@ void LayoutDeleteCommand::undo()
 
 void LayoutDeleteCommand::redo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     for (const auto& rec : _records)
         _visualMode.getScene()->deleteWidgetByPath(rec.path);
 
@@ -324,6 +328,8 @@ void LayoutCreateCommand::generateName()
 
 void LayoutCreateCommand::undo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     QUndoCommand::undo();
     _visualMode.getScene()->deleteWidgetByPath(_fullPath);
     _visualMode.getScene()->updatePropertySet();
@@ -331,6 +337,8 @@ void LayoutCreateCommand::undo()
 
 void LayoutCreateCommand::redo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     // Most of (but not all) widgets require a font to be rendered properly
     _visualMode.getScene()->ensureDefaultFontExists();
 
@@ -525,7 +533,7 @@ void LayoutPropertyEditCommand::setProperty(const QString& widgetPath, const CEG
     try
     {
         CEGUIUtils::setWidgetProperty(manipulator->getWidget(), _propertyName, value);
-        manipulator->updateFromWidget(false, true);
+        _visualMode.getScene()->scheduleGeometryUpdate(manipulator);
         manipulator->update();
         manipulator->updatePropertiesFromWidget(propertiesToUpdate);
         _invalidValue = false;
@@ -590,7 +598,7 @@ void LayoutHorizontalAlignCommand::undo()
     {
         auto manipulator = _visualMode.getScene()->getManipulatorByPath(rec.path);
         manipulator->getWidget()->setHorizontalAlignment(rec.oldAlignment);
-        manipulator->updateFromWidget();
+        _visualMode.getScene()->scheduleGeometryUpdate(manipulator);
 
         manipulator->updatePropertiesFromWidget({"HorizontalAlignment"});
     }
@@ -602,7 +610,7 @@ void LayoutHorizontalAlignCommand::redo()
     {
         auto manipulator = _visualMode.getScene()->getManipulatorByPath(rec.path);
         manipulator->getWidget()->setHorizontalAlignment(_newAlignment);
-        manipulator->updateFromWidget();
+        _visualMode.getScene()->scheduleGeometryUpdate(manipulator);
 
         manipulator->updatePropertiesFromWidget({"HorizontalAlignment"});
     }
@@ -662,7 +670,7 @@ void LayoutVerticalAlignCommand::undo()
     {
         auto manipulator = _visualMode.getScene()->getManipulatorByPath(rec.path);
         manipulator->getWidget()->setVerticalAlignment(rec.oldAlignment);
-        manipulator->updateFromWidget();
+        _visualMode.getScene()->scheduleGeometryUpdate(manipulator);
 
         manipulator->updatePropertiesFromWidget({"VerticalAlignment"});
     }
@@ -674,7 +682,7 @@ void LayoutVerticalAlignCommand::redo()
     {
         auto manipulator = _visualMode.getScene()->getManipulatorByPath(rec.path);
         manipulator->getWidget()->setVerticalAlignment(_newAlignment);
-        manipulator->updateFromWidget();
+        _visualMode.getScene()->scheduleGeometryUpdate(manipulator);
 
         manipulator->updatePropertiesFromWidget({"VerticalAlignment"});
     }
@@ -777,6 +785,8 @@ LayoutMoveInHierarchyCommand::LayoutMoveInHierarchyCommand(LayoutVisualMode& vis
 
 void LayoutMoveInHierarchyCommand::undo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     QUndoCommand::undo();
 
     _visualMode.getScene()->clearSelection();
@@ -819,6 +829,7 @@ void LayoutMoveInHierarchyCommand::undo()
         const size_t destIndex = rec.oldChildIndex > currIndex ? rec.oldChildIndex + 1 : rec.oldChildIndex;
         if (destIndex <= oldParentManipulator->getWidget()->getChildCount())
             oldParentManipulator->getWidget()->moveChildToIndex(currIndex, destIndex);
+        _visualMode.getScene()->onManipulatorChildrenChanged(oldParentManipulator);
 
         // Update widget and its previous parent (the second is mostly for the layout container case)
         widgetManipulator->updateFromWidget(true, true);
@@ -830,6 +841,8 @@ void LayoutMoveInHierarchyCommand::undo()
 
 void LayoutMoveInHierarchyCommand::redo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     _visualMode.getScene()->clearSelection();
     _visualMode.getHierarchyDockWidget()->getTreeView()->clearSelection();
 
@@ -866,6 +879,7 @@ void LayoutMoveInHierarchyCommand::redo()
 
         if (rec.newChildIndex <= newParentManipulator->getWidget()->getChildCount())
             newParentManipulator->getWidget()->moveChildToIndex(widgetManipulator->getWidget(), rec.newChildIndex);
+        _visualMode.getScene()->onManipulatorChildrenChanged(newParentManipulator);
 
         // Update widget and its previous parent (the second is mostly for the layout container case)
         widgetManipulator->updateFromWidget(true, true);
@@ -890,6 +904,8 @@ LayoutPasteCommand::LayoutPasteCommand(LayoutVisualMode& visualMode,
 
 void LayoutPasteCommand::undo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     QUndoCommand::undo();
 
     for (const QString& path : _createdWidgets)
@@ -902,13 +918,15 @@ void LayoutPasteCommand::undo()
 
 void LayoutPasteCommand::redo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     LayoutScene* scene = _visualMode.getScene();
     auto target = scene->getManipulatorByPath(_targetPath);
 
     scene->clearSelection();
 
-    QDataStream stream(&_data, QIODevice::ReadOnly);
-    while (!stream.atEnd())
+    CEGUIWidgetSerializer reader(_data);
+    while (!reader.atEnd())
     {
         if (!target && !_createdWidgets.empty())
         {
@@ -916,7 +934,7 @@ void LayoutPasteCommand::redo()
             break;
         }
 
-        if (auto manipulator = CreateManipulatorFromDataStream(_visualMode, target, stream))
+        if (auto manipulator = CreateManipulatorFromSerializedData(_visualMode, target, reader))
             _createdWidgets.push_back(manipulator->getWidgetPath());
     }
 
@@ -954,6 +972,8 @@ LayoutDuplicateCommand::LayoutDuplicateCommand(LayoutVisualMode& visualMode, std
 
 void LayoutDuplicateCommand::undo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     QUndoCommand::undo();
 
     for (const QString& path : _createdWidgets)
@@ -966,14 +986,16 @@ void LayoutDuplicateCommand::undo()
 
 void LayoutDuplicateCommand::redo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     _visualMode.getScene()->clearSelection();
 
     for (auto& rec : _records)
     {
         auto parentManipulator = _visualMode.getScene()->getManipulatorByPath(rec.parentPath);
 
-        QDataStream stream(&rec.data, QIODevice::ReadOnly);
-        if (auto manipulator = CreateManipulatorFromDataStream(_visualMode, parentManipulator, stream, rec.childIndex + 1))
+        CEGUIWidgetSerializer reader(rec.data);
+        if (auto manipulator = CreateManipulatorFromSerializedData(_visualMode, parentManipulator, reader, rec.childIndex + 1))
         {
             _createdWidgets.push_back(manipulator->getWidgetPath());
             parentManipulator->updateFromWidget(true, true);
@@ -1043,6 +1065,8 @@ MoveInParentWidgetListCommand::MoveInParentWidgetListCommand(LayoutVisualMode& v
 
 void MoveInParentWidgetListCommand::undo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     QUndoCommand::undo();
 
     if (!_delta) return;
@@ -1058,12 +1082,14 @@ void MoveInParentWidgetListCommand::undo()
         assert(newPos == parentManipulator->getWidget()->getChildIndex(manipulator->getWidget()));
 
         parentManipulator->updateFromWidget(true, true);
-        parentManipulator->getTreeItem()->refreshOrderingData();
+        _visualMode.getScene()->onManipulatorChildrenChanged(parentManipulator);
     }
 }
 
 void MoveInParentWidgetListCommand::redo()
 {
+    _visualMode.getScene()->finishBuildingManipulators();
+
     if (!_delta) return;
 
     for (const QString& path : _paths)
@@ -1077,7 +1103,7 @@ void MoveInParentWidgetListCommand::redo()
         assert(newPos == parentManipulator->getWidget()->getChildIndex(manipulator->getWidget()));
 
         parentManipulator->updateFromWidget(true, true);
-        parentManipulator->getTreeItem()->refreshOrderingData();
+        _visualMode.getScene()->onManipulatorChildrenChanged(parentManipulator);
     }
 
     QUndoCommand::redo();
@@ -2,6 +2,7 @@
 #include "src/editors/layout/LayoutEditor.h"
 #include "src/editors/layout/LayoutUndoCommands.h"
 #include "src/cegui/CEGUIUtils.h"
+#include "src/cegui/CEGUIWidgetSerializer.h"
 #include "src/ui/CEGUIWidget.h"
 #include "src/ui/CEGUIGraphicsView.h"
 #include "src/ui/layout/LayoutScene.h"
@@ -268,18 +269,15 @@ bool LayoutVisualMode::copy()
 
     if (selectedWidgets.empty()) return false;
 
-    QByteArray bytes;
-    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    std::vector<const CEGUI::Window*> widgets;
     for (LayoutManipulator* manipulator : selectedWidgets)
-    {
-        if (!CEGUIUtils::serializeWidget(*manipulator->getWidget(), stream, true))
-            return false;
-    }
+        widgets.push_back(manipulator->getWidget());
 
+    QByteArray bytes = CEGUIWidgetSerializer::serialize(widgets);
     if (!bytes.size()) return false;
 
     QMimeData* mimeData = new QMimeData();
-    mimeData->setData("application/x-ceed-widget-hierarchy-list", bytes);
+    mimeData->setData(CEGUIWidgetSerializer::MimeType, bytes);
     QApplication::clipboard()->setMimeData(mimeData);
 
     return true;
@@ -288,9 +286,9 @@ bool LayoutVisualMode::copy()
 bool LayoutVisualMode::paste()
 {
     const QMimeData* mimeData = QApplication::clipboard()->mimeData();
-    if (!mimeData->hasFormat("application/x-ceed-widget-hierarchy-list")) return false;
-    QByteArray bytes = mimeData->data("application/x-ceed-widget-hierarchy-list");
-    if (bytes.size() <= 0) return false;
+    if (!mimeData->hasFormat(CEGUIWidgetSerializer::MimeType)) return false;
+    QByteArray bytes = mimeData->data(CEGUIWidgetSerializer::MimeType);
+    if (bytes.size() <= 0 || !CEGUIWidgetSerializer(bytes).isValid()) return false;
 
     std::set<LayoutManipulator*> selectedWidgets;
     scene->collectSelectedWidgets(selectedWidgets);
@@ -317,7 +315,6 @@ bool LayoutVisualMode::duplicate()
 
     std::vector<LayoutDuplicateCommand::Record> records;
 
-    QByteArray bytes;
     for (LayoutManipulator* manipulator : selectedWidgets)
     {
         auto parentManipulator = dynamic_cast<LayoutManipulator*>(manipulator->parentItem());
@@ -325,14 +322,11 @@ bool LayoutVisualMode::duplicate()
         // Can't duplicate the root
         if (!parentManipulator) continue;
 
-        QDataStream stream(&bytes, QIODevice::WriteOnly);
-        if (!CEGUIUtils::serializeWidget(*manipulator->getWidget(), stream, true))
-            return false;
-
+        QByteArray bytes = CEGUIWidgetSerializer::serialize({ manipulator->getWidget() });
         if (!bytes.size()) continue;
 
         LayoutDuplicateCommand::Record rec;
-        std::swap(rec.data, bytes);
+        rec.data = std::move(bytes);
         rec.name = manipulator->getWidgetName();
         rec.childIndex = manipulator->getWidgetIndexInParent();
         rec.parentPath = parentManipulator->getWidgetPath();
@@ -3,8 +3,11 @@
 #include "src/cegui/CEGUIManager.h"
 #include "src/cegui/CEGUIUtils.h"
 #include "src/util/Settings.h"
+#include "src/util/FrameProfiler.h"
 #include "src/Application.h"
 #include "qtextbrowser.h"
+#include "qfiledialog.h"
+#include "qmessagebox.h"
 
 CEGUIDebugInfo::CEGUIDebugInfo(QWidget *parent) :
     QDialog(parent),
@@ -26,6 +29,10 @@ CEGUIDebugInfo::CEGUIDebugInfo(QWidget *parent) :
 
     auto&& settings = qobject_cast<Application*>(qApp)->getSettings();
     messageLimit = settings->getEntryValue("global/cegui_debug_info/log_limit").toInt();
+
+    // Profiling may also be toggled from a view
+    ui->profileCheckBox->setChecked(FrameProfiler::Instance().isEnabled());
+    connect(&FrameProfiler::Instance(), &FrameProfiler::enabledChanged, ui->profileCheckBox, &QCheckBox::setChecked);
 }
 
 CEGUIDebugInfo::~CEGUIDebugInfo()
@@ -96,3 +103,26 @@ void CEGUIDebugInfo::logEvent(const CEGUI::String& message, CEGUI::LoggingLevel
 
     logMessages.append(qmessage);
 }
+
+void CEGUIDebugInfo::on_profileCheckBox_toggled(bool checked)
+{
+    FrameProfiler::Instance().setEnabled(checked);
+}
+
+void CEGUIDebugInfo::on_exportCSVButton_clicked()
+{
+    const QString filePath = QFileDialog::getSaveFileName(this, "Export frame profile", "frames.csv", "CSV files (*.csv)");
+    if (filePath.isEmpty()) return;
+
+    if (!FrameProfiler::Instance().exportCSV(filePath))
+        QMessageBox::warning(this, "Export failed", "Can't write frame profile to " + filePath);
+}
+
+void CEGUIDebugInfo::on_exportTraceButton_clicked()
+{
+    const QString filePath = QFileDialog::getSaveFileName(this, "Export frame profile", "frames.json", "Chrome trace files (*.json)");
+    if (filePath.isEmpty()) return;
+
+    if (!FrameProfiler::Instance().exportChromeTrace(filePath))
+        QMessageBox::warning(this, "Export failed", "Can't write frame profile to " + filePath);
+}
@@ -23,6 +23,11 @@ public:
     void show();
     void logEvent(const CEGUI::String& message, CEGUI::LoggingLevel level);
 
+private slots:
+    void on_profileCheckBox_toggled(bool checked);
+    void on_exportCSVButton_clicked();
+    void on_exportTraceButton_clicked();
+
 private:
     Ui::CEGUIDebugInfo *ui;
     QTextBrowser* logView = nullptr;
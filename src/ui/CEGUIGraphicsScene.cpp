@@ -2,7 +2,7 @@
 #include "src/cegui/CEGUIManager.h"
 #include "src/cegui/CEGUIProject.h"
 #include "src/Application.h"
-#include <CEGUI/RendererModules/OpenGL/RendererBase.h>
+#include "src/util/FrameProfiler.h"
 #include <CEGUI/RendererModules/OpenGL/ViewportTarget.h>
 #include <CEGUI/System.h>
 #include <CEGUI/GUIContext.h>
@@ -15,6 +15,7 @@
 #include <qopenglframebufferobject.h>
 #include <qmessagebox.h>
 #include <qdir.h>
+#include <qtimer.h>
 
 static void validateResolution(float& width, float& height)
 {
@@ -46,25 +47,20 @@ CEGUIGraphicsScene::CEGUIGraphicsScene(QObject* parent, float width, float heigh
     const qreal qHeight = static_cast<qreal>(height);
     setSceneRect(QRectF(-padding, -padding, qWidth + 2.0 * padding, qHeight + 2.0 * padding));
 
-    auto renderer = static_cast<CEGUI::OpenGLRendererBase*>(CEGUI::System::getSingleton().getRenderer());
-    auto renderTarget = new CEGUI::OpenGLViewportTarget(*renderer, CEGUI::Rectf(0.f, 0.f, contextWidth, contextHeight));
+    auto renderTarget = CEGUIManager::Instance().acquireViewportTarget(contextWidth, contextHeight);
     ceguiContext = &CEGUI::System::getSingleton().createGUIContext(*renderTarget);
 }
 
 CEGUIGraphicsScene::~CEGUIGraphicsScene()
 {
-    if (_fbo)
-    {
-        CEGUIManager::Instance().makeOpenGLContextCurrent();
-        delete _fbo;
-        CEGUIManager::Instance().doneOpenGLContextCurrent();
-    }
+    // Render targets are returned to the pool, the manager destroys them when they aren't reused
+    releaseOffscreenBuffer();
 
     if (ceguiContext)
     {
-        auto renderTarget = &ceguiContext->getRenderTarget();
+        auto renderTarget = dynamic_cast<CEGUI::OpenGLViewportTarget*>(&ceguiContext->getRenderTarget());
         CEGUI::System::getSingleton().destroyGUIContext(*ceguiContext);
-        delete renderTarget;
+        CEGUIManager::Instance().releaseViewportTarget(renderTarget);
     }
 }
 
@@ -89,24 +85,76 @@ void CEGUIGraphicsScene::setCEGUIDisplaySize(float width, float height)
     area.setSize(newSize);
     renderTarget.setArea(area);
 
+    invalidateCEGUIContext();
     update();
 }
 
 // Renders CEGUI context to texture using FBO. All shared contexts can then access FBO texture.
+// Rendering is skipped if CEGUI has nothing changed, the texture from the last render is still valid.
 void CEGUIGraphicsScene::drawCEGUIContextOffscreen()
 {
     if (!ceguiContext) return;
 
+    injectTimePulse();
+
+    // The request is for the first frame after activation only, even if nothing changed since then
+    const bool presentCachedFrame = _presentCachedFrame;
+    _presentCachedFrame = false;
+
+    if (!isCEGUIContextDirty()) return;
+
+    // The last frame is good enough to be shown right after activation, an actual one will follow
+    if (presentCachedFrame)
+    {
+        if (_fbo && _fboContentSize == QSize(static_cast<int>(contextWidth), static_cast<int>(contextHeight)))
+        {
+            CEGUIManager::Instance().onOffscreenBufferUsed(this, false);
+            QTimer::singleShot(0, this, [this]() { update(); });
+            return;
+        }
+    }
+
+    drawCEGUIContextInternal();
+    CEGUIManager::Instance().doneOpenGLContextCurrent();
+}
+
+// Drops the last rendered frame, it will be rendered from scratch when needed
+void CEGUIGraphicsScene::releaseOffscreenBuffer(bool reuse)
+{
+    if (!_fbo) return;
+
+    CEGUIManager::Instance().onOffscreenBufferReleased(this);
+    CEGUIManager::Instance().releaseFBO(_fbo, reuse);
+    _fbo = nullptr;
+    _fboContentSize = QSize();
+}
+
+void CEGUIGraphicsScene::injectTimePulse()
+{
+    FrameProfiler::Scope profileScope("CEGUI time pulse");
+
+    if (!ceguiContext) return;
+
     qint64 currTime = QDateTime::currentMSecsSinceEpoch();
     lastDelta = currTime - timeOfLastRender;
     timeOfLastRender = currTime;
 
-    // Inject the time passed since the last render all at once
+    // Inject the time passed since the last pulse all at once
     CEGUI::System::getSingleton().injectTimePulse(static_cast<float>(lastDelta));
     ceguiContext->injectTimePulse(static_cast<float>(lastDelta));
+}
 
-    drawCEGUIContextInternal();
-    CEGUIManager::Instance().doneOpenGLContextCurrent();
+// CEGUI marks the context dirty when any of its windows is invalidated, e.g. by a property change or an animation
+bool CEGUIGraphicsScene::isCEGUIContextDirty() const
+{
+    if (!ceguiContext) return false;
+
+    if (_ceguiContextDirty || !_fbo) return true;
+
+    if (_fboContentSize.width() != static_cast<int>(contextWidth) || _fboContentSize.height() != static_cast<int>(contextHeight))
+        return true;
+
+    return ceguiContext->isDirty();
 }
 
 QImage CEGUIGraphicsScene::getCEGUIScreenshot()
@@ -115,7 +163,10 @@ QImage CEGUIGraphicsScene::getCEGUIScreenshot()
 
     drawCEGUIContextInternal();
 
+    // The context is rendered to the bottom-left corner of the buffer, which is the bottom of the image
     QImage result = _fbo->toImage();
+    if (result.size() != _fboContentSize)
+        result = result.copy(0, result.height() - _fboContentSize.height(), _fboContentSize.width(), _fboContentSize.height());
 
     CEGUIManager::Instance().doneOpenGLContextCurrent();
 
@@ -207,20 +258,28 @@ void CEGUIGraphicsScene::mousePressEvent(QGraphicsSceneMouseEvent* event)
 // NB: it doesn't disable context, callers may need it for further operations
 void CEGUIGraphicsScene::drawCEGUIContextInternal()
 {
+    FrameProfiler::Scope profileScope("CEGUI render");
+
     if (!ceguiContext) return;
 
     CEGUIManager::Instance().ensureCEGUIInitialized();
     CEGUIManager::Instance().makeOpenGLContextCurrent();
 
-    // FBO is not per-view at least for now because we render only one CEGUI view at a time anyway
+    // FBO is not per-view at least for now because we render only one CEGUI view at a time anyway.
+    // A larger buffer is reused with a sub-rect viewport. It is replaced only when it doesn't fit
+    // or wastes too much memory, so resolution changes don't reallocate GPU memory every frame.
     const int w = static_cast<int>(contextWidth);
     const int h = static_cast<int>(contextHeight);
-    if (!_fbo || _fbo->size().width() != w || _fbo->size().height() != h)
+    const bool acquire = (!_fbo || _fbo->width() < w || _fbo->height() < h ||
+            static_cast<qint64>(_fbo->width()) * _fbo->height() > 4 * static_cast<qint64>(w) * h);
+    if (acquire)
     {
-        if (_fbo) delete _fbo;
-        _fbo = new QOpenGLFramebufferObject(w, h);
+        CEGUIManager::Instance().releaseFBO(_fbo);
+        _fbo = CEGUIManager::Instance().acquireFBO(w, h);
     }
 
+    CEGUIManager::Instance().onOffscreenBufferUsed(this, acquire);
+
     if (_fbo->bind())
     {
         auto gl = QOpenGLContext::currentContext()->functions();
@@ -233,5 +292,8 @@ void CEGUIGraphicsScene::drawCEGUIContextInternal()
         renderer->endRendering();
 
         _fbo->release();
+
+        _fboContentSize = QSize(w, h);
+        _ceguiContextDirty = false;
     }
 }
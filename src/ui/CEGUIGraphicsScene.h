@@ -22,6 +22,9 @@ public:
 
     virtual void setCEGUIDisplaySize(float width, float height);
     void drawCEGUIContextOffscreen();
+    void injectTimePulse();
+    bool isCEGUIContextDirty() const;
+    void invalidateCEGUIContext() { _ceguiContextDirty = true; }
     QImage getCEGUIScreenshot();
 
     qint64 getLastDeltaMSec() const { return lastDelta; }
@@ -30,7 +33,11 @@ public:
     float getContextHeight() const { return contextHeight; }
     QList<QGraphicsItem*> topLevelItems() const;
 
+    // The buffer comes from a shared pool and may be larger than the context, see getOffscreenBufferContentSize()
     QOpenGLFramebufferObject* getOffscreenBuffer() const { return _fbo; }
+    QSize getOffscreenBufferContentSize() const { return _fboContentSize; }
+    void releaseOffscreenBuffer(bool reuse = true);
+    void presentCachedFrameOnce() { _presentCachedFrame = true; }
 
     bool ensureDefaultFontExists();
 
@@ -42,10 +49,14 @@ protected:
 
     CEGUI::GUIContext* ceguiContext = nullptr;
     QOpenGLFramebufferObject* _fbo = nullptr;
+    QSize _fboContentSize; // Bottom-left part of _fbo where the context was rendered last time
 
     qint64 lastDelta = 0;
     qint64 timeOfLastRender;
 
+    bool _ceguiContextDirty = true; // Forces rendering even if CEGUI reports no changes
+    bool _presentCachedFrame = false; // Show the last rendered frame instantly and refresh it in the next frame
+
     qreal padding = 30.0;
     float contextWidth = 0.f;
     float contextHeight = 0.f;
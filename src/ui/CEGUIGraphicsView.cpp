@@ -1,5 +1,7 @@
 #include "src/ui/CEGUIGraphicsView.h"
 #include "src/ui/CEGUIGraphicsScene.h"
+#include "src/ui/FrameProfilerOverlay.h"
+#include "src/util/FrameProfiler.h"
 #include "src/util/Settings.h"
 #include "src/util/SettingsEntry.h"
 #include "src/util/Utils.h"
@@ -26,9 +28,13 @@ CEGUIGraphicsView::CEGUIGraphicsView(QWidget *parent) :
     if (helpLabel) viewport()->stackUnder(helpLabel);
 
     //setViewport(new QOpenGLWidget());
-    setViewportUpdateMode(FullViewportUpdate);
 
-    setOptimizationFlags(DontClipPainter | DontAdjustForAntialiasing);
+    // Overlay changes (hover, rubber band, guides) repaint only affected regions, CEGUI texture is reused
+    // there. QOpenGLWidget must preserve its contents between frames for that. The view update mode is
+    // SmartViewportUpdate, it is set in CEGUIWidget.ui because setupUi runs after this constructor.
+    static_cast<QOpenGLWidget*>(viewport())->setUpdateBehavior(QOpenGLWidget::PartialUpdate);
+
+    setOptimizationFlags(DontAdjustForAntialiasing);
 
     // Prepare to receive input
     setMouseTracking(true);
@@ -37,8 +43,16 @@ CEGUIGraphicsView::CEGUIGraphicsView(QWidget *parent) :
 
     blitter = new QOpenGLTextureBlitter();
 
+    _frameTimer = new QTimer(this);
+    _frameTimer->setInterval(1000 / 60);
+    connect(_frameTimer, &QTimer::timeout, this, &CEGUIGraphicsView::onFrameTimer);
+
     updateCheckerboardBrush();
 
+    _profilerOverlay = new FrameProfilerOverlay(this);
+    _profilerOverlay->setVisible(FrameProfiler::Instance().isEnabled());
+    connect(&FrameProfiler::Instance(), &FrameProfiler::enabledChanged, _profilerOverlay, &FrameProfilerOverlay::setVisible);
+
     auto&& settings = qobject_cast<Application*>(qApp)->getSettings();
     connect(settings->getEntry("cegui/background/checker_width"), &SettingsEntry::valueChanged, this, &CEGUIGraphicsView::updateCheckerboardBrush);
     connect(settings->getEntry("cegui/background/checker_height"), &SettingsEntry::valueChanged, this, &CEGUIGraphicsView::updateCheckerboardBrush);
@@ -65,11 +79,34 @@ void CEGUIGraphicsView::injectInput(bool inject)
     _injectInput = inject;
 }
 
+void CEGUIGraphicsView::setContinuousRendering(bool on)
+{
+    continuousRendering = on;
+    if (on)
+        _frameTimer->start();
+    else
+        _frameTimer->stop();
+}
+
+// Advances CEGUI time and repaints only if this changed anything, e.g. an animation is playing.
+// Idle views don't render at all.
+void CEGUIGraphicsView::onFrameTimer()
+{
+    auto ceguiScene = static_cast<CEGUIGraphicsScene*>(scene());
+    if (!ceguiScene || !isVisible()) return;
+
+    ceguiScene->injectTimePulse();
+    if (ceguiScene->isCEGUIContextDirty())
+        viewport()->update();
+}
+
 // We override this and draw CEGUI instead of the whole background.
 // This method uses a FBO to implement zooming, scrolling around, etc...
 // FBOs are therefore required by CEED and it won't run without a GPU that supports them.
 void CEGUIGraphicsView::drawBackground(QPainter* painter, const QRectF& rect)
 {
+    FrameProfiler::Scope profileScope("View background");
+
     auto painterType = painter->paintEngine()->type();
     if (painterType != QPaintEngine::OpenGL && painterType != QPaintEngine::OpenGL2)
     {
@@ -108,36 +145,61 @@ void CEGUIGraphicsView::drawBackground(QPainter* painter, const QRectF& rect)
     gl->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     gl->glViewport(0, 0, viewport()->width(), viewport()->height());
 
+    // Native painting ignores the painter clip, so limit blitting to the exposed area manually
+    const QRect exposedRect = mapFromScene(rect).boundingRect().intersected(viewport()->rect());
+    gl->glEnable(GL_SCISSOR_TEST);
+    gl->glScissor(exposedRect.x(), viewport()->height() - exposedRect.y() - exposedRect.height(), exposedRect.width(), exposedRect.height());
+
     if (QOpenGLFramebufferObject* fbo = ceguiScene->getOffscreenBuffer())
     {
+        // Exposed rect may be a part of the view, so map to the whole visible area
+        const QRect visibleSceneRect = mapToScene(viewport()->rect()).boundingRect().toRect();
+
         if (!blitter->isCreated()) blitter->create();
         blitter->bind();
-        const QMatrix4x4 target = QOpenGLTextureBlitter::targetTransform(viewportRect, rect.toRect());
-        blitter->blit(fbo->texture(), target, QOpenGLTextureBlitter::OriginBottomLeft);
+        const QMatrix4x4 target = QOpenGLTextureBlitter::targetTransform(viewportRect, visibleSceneRect);
+
+        // Pooled buffer may be larger than the context, which is rendered into its bottom-left corner
+        const QMatrix3x3 source = QOpenGLTextureBlitter::sourceTransform(
+                    QRectF(QPointF(0.0, 0.0), ceguiScene->getOffscreenBufferContentSize()), fbo->size(), QOpenGLTextureBlitter::OriginBottomLeft);
+        FrameProfiler::Scope blitProfileScope("FBO blit");
+        blitter->blit(fbo->texture(), target, source);
         blitter->release();
     }
 
+    gl->glDisable(GL_SCISSOR_TEST);
+
     painter->endNativePainting();
 
     CEGUI::WindowManager::getSingleton().cleanDeadPool();
 
-    if (continuousRendering)
+    if (FrameProfiler::Instance().isEnabled())
+        _itemsPaintStart = FrameProfiler::Instance().now();
+}
+
+void CEGUIGraphicsView::drawForeground(QPainter* painter, const QRectF& rect)
+{
+    auto& profiler = FrameProfiler::Instance();
+    if (_itemsPaintStart && profiler.isEnabled())
+        profiler.addEvent("Qt items", _itemsPaintStart, profiler.now() - _itemsPaintStart);
+    _itemsPaintStart = 0;
+
+    ResizableGraphicsView::drawForeground(painter, rect);
+}
+
+void CEGUIGraphicsView::paintEvent(QPaintEvent* event)
+{
+    auto& profiler = FrameProfiler::Instance();
+    if (!profiler.isEnabled())
     {
-        constexpr float desiredFPS = 60.f;
-        constexpr float frameTimeMsec = (desiredFPS <= 0.f) ? 0.f : (1000.0f / desiredFPS);
-
-        const float lastDeltaMSec = static_cast<float>(ceguiScene->getLastDeltaMSec()); //???per-view?
-        const qint64 msecLeft = std::max(static_cast<qint64>(0), static_cast<qint64>(frameTimeMsec - lastDeltaMSec));
-
-        // Direct call to update() from inside here doesn't seem to work, so we schedule a
-        // timer signal even if the time of the next frame has come.
-        QTimer::singleShot(msecLeft, [this]()
-        {
-            update();
-            if (scene())
-                scene()->update();
-        });
+        ResizableGraphicsView::paintEvent(event);
+        return;
     }
+
+    _itemsPaintStart = 0;
+    const qint64 start = profiler.now();
+    ResizableGraphicsView::paintEvent(event);
+    profiler.endFrame(start, profiler.now() - start);
 }
 
 void CEGUIGraphicsView::updateCheckerboardBrush()
@@ -225,6 +287,15 @@ void CEGUIGraphicsView::mouseReleaseEvent(QMouseEvent* event)
 
 void CEGUIGraphicsView::keyPressEvent(QKeyEvent* event)
 {
+    // Frame profiler overlay toggle
+    if (event->key() == Qt::Key_F12 && event->modifiers() == Qt::ControlModifier)
+    {
+        auto& profiler = FrameProfiler::Instance();
+        profiler.setEnabled(!profiler.isEnabled());
+        event->accept();
+        return;
+    }
+
     // Process CEGUI input
     if (_injectInput)
     {
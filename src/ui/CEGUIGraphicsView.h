@@ -7,6 +7,8 @@
 // QOpenGLWidget. It's designed to work with CEGUIGraphicsScene derived classes.
 
 class QOpenGLTextureBlitter;
+class QTimer;
+class FrameProfilerOverlay;
 
 class CEGUIGraphicsView final : public ResizableGraphicsView
 {
@@ -18,9 +20,10 @@ public:
     virtual ~CEGUIGraphicsView() override;
 
     void injectInput(bool inject);
-    void setContinuousRendering(bool on) { continuousRendering = on; }
+    void setContinuousRendering(bool on);
 
     virtual void drawBackground(QPainter* painter, const QRectF& rect) override;
+    virtual void drawForeground(QPainter* painter, const QRectF& rect) override;
 
 signals:
 
@@ -29,7 +32,9 @@ signals:
 private:
 
     void updateCheckerboardBrush();
+    void onFrameTimer();
 
+    virtual void paintEvent(QPaintEvent* event) override;
     virtual void wheelEvent(QWheelEvent *event) override;
     virtual void mouseMoveEvent(QMouseEvent* event) override;
     virtual void mousePressEvent(QMouseEvent* event) override;
@@ -38,13 +43,17 @@ private:
     virtual void keyReleaseEvent(QKeyEvent* event) override;
 
     QOpenGLTextureBlitter* blitter = nullptr;
+    QTimer* _frameTimer = nullptr;
+    FrameProfilerOverlay* _profilerOverlay = nullptr;
     QBrush checkerboardBrush;
 
+    qint64 _itemsPaintStart = 0; // For profiling, Qt items are painted between the background and the foreground
+
     bool _injectInput = false;
 
-    // if true, we render always (possibly capped to some FPS) - suitable for live preview
+    // if true, we advance CEGUI time always (capped to some FPS) and render when CEGUI changes - suitable for live preview
     // if false, we render only when update() is called - suitable for visual editing
-    bool continuousRendering = true;
+    bool continuousRendering = false;
 };
 
 #endif // CEGUIGRAPHICSVIEW_H
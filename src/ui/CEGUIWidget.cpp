@@ -169,3 +169,12 @@ bool CEGUIWidget::eventFilter(QObject* obj, QEvent* ev)
         QTimer::singleShot(0, ui->resolutionBox->lineEdit(), &QLineEdit::selectAll);
     return false;
 }
+
+void CEGUIWidget::showEvent(QShowEvent* event)
+{
+    // Don't make the user wait for a full CEGUI render when switching tabs
+    if (auto scene = getScene())
+        scene->presentCachedFrameOnce();
+
+    QWidget::showEvent(event);
+}
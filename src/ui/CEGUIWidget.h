@@ -42,6 +42,7 @@ protected slots:
 protected:
 
     virtual bool eventFilter(QObject* obj, QEvent* ev) override;
+    virtual void showEvent(QShowEvent* event) override;
 
     Ui::CEGUIWidget *ui;
 };
@@ -0,0 +1,122 @@
+#include "src/ui/FrameProfilerOverlay.h"
+#include "src/util/FrameProfiler.h"
+#include <qabstractscrollarea.h>
+#include <qpainter.h>
+#include <qtimer.h>
+#include <algorithm>
+#include <cstring>
+
+static const int RefreshIntervalMsec = 250;
+static const quint32 StatsFrameCount = 60;
+static const int HistogramBuckets = 34; // 1 ms each, the last one is for longer frames
+static const int HistogramHeight = 60;
+static const int Margin = 6;
+static const int OverlayWidth = 320;
+
+FrameProfilerOverlay::FrameProfilerOverlay(QWidget* parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+
+    auto fontCopy = font();
+    fontCopy.setPointSize(8);
+    setFont(fontCopy);
+
+    _refreshTimer = new QTimer(this);
+    _refreshTimer->setInterval(RefreshIntervalMsec);
+    connect(_refreshTimer, &QTimer::timeout, [this]()
+    {
+        const auto stats = FrameProfiler::Instance().getRecentStats(StatsFrameCount);
+        const int lineCount = 1 + static_cast<int>(stats.size());
+        resize(OverlayWidth, lineCount * fontMetrics().height() + HistogramHeight + 3 * Margin);
+
+        // Top-right corner of the visible area
+        QRect area = parentWidget() ? parentWidget()->rect() : QRect();
+        if (auto scrollArea = qobject_cast<QAbstractScrollArea*>(parentWidget()))
+            area = scrollArea->viewport()->geometry();
+        move(area.right() - width() - Margin, area.top() + Margin);
+
+        update();
+    });
+
+    setVisible(false);
+}
+
+void FrameProfilerOverlay::showEvent(QShowEvent* event)
+{
+    _refreshTimer->start();
+    QWidget::showEvent(event);
+}
+
+void FrameProfilerOverlay::hideEvent(QHideEvent* event)
+{
+    _refreshTimer->stop();
+    QWidget::hideEvent(event);
+}
+
+void FrameProfilerOverlay::paintEvent(QPaintEvent* /*event*/)
+{
+    const auto& profiler = FrameProfiler::Instance();
+    const auto frameTimes = profiler.getFrameTimes();
+    const auto stats = profiler.getRecentStats(StatsFrameCount);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(32, 32, 32, 192));
+    painter.setPen(Qt::white);
+
+    const int lineHeight = fontMetrics().height();
+    const int textWidth = width() - 2 * Margin;
+    int y = Margin;
+
+    // Summary over all remembered frames
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+    for (qint64 frameTime : frameTimes)
+    {
+        totalNs += frameTime;
+        maxNs = std::max(maxNs, frameTime);
+    }
+    const double avgMs = frameTimes.empty() ? 0.0 : totalNs / 1000000.0 / frameTimes.size();
+    painter.drawText(Margin, y, textWidth, lineHeight, Qt::AlignLeft | Qt::AlignVCenter,
+                     QString("Frame: avg %1 ms, max %2 ms (%3 frames)")
+                     .arg(avgMs, 0, 'f', 2).arg(maxNs / 1000000.0, 0, 'f', 2).arg(frameTimes.size()));
+    y += lineHeight;
+
+    // Per-scope times, averaged per frame, so that CEGUI and editor overhead can be compared directly
+    const quint32 frameCount = std::max(1u, std::min(StatsFrameCount, profiler.getFrameIndex()));
+    for (const auto& scope : stats)
+    {
+        if (!std::strcmp(scope.name, "Frame")) continue;
+
+        painter.drawText(Margin, y, textWidth, lineHeight, Qt::AlignLeft | Qt::AlignVCenter,
+                         QString("%1: %2 ms/frame, max %3 ms, %4 calls")
+                         .arg(scope.name)
+                         .arg(scope.totalNs / 1000000.0 / frameCount, 0, 'f', 2)
+                         .arg(scope.maxNs / 1000000.0, 0, 'f', 2)
+                         .arg(scope.count));
+        y += lineHeight;
+    }
+
+    y += Margin;
+
+    // Histogram of frame times
+    std::vector<int> buckets(HistogramBuckets, 0);
+    for (qint64 frameTime : frameTimes)
+        ++buckets[static_cast<size_t>(std::min<qint64>(frameTime / 1000000, HistogramBuckets - 1))];
+
+    const int maxCount = std::max(1, *std::max_element(buckets.cbegin(), buckets.cend()));
+    const qreal bucketWidth = static_cast<qreal>(textWidth) / HistogramBuckets;
+    for (int i = 0; i < HistogramBuckets; ++i)
+    {
+        if (!buckets[static_cast<size_t>(i)]) continue;
+
+        const qreal barHeight = static_cast<qreal>(HistogramHeight) * buckets[static_cast<size_t>(i)] / maxCount;
+        const QRectF bar(Margin + i * bucketWidth, y + HistogramHeight - barHeight, bucketWidth - 1.0, barHeight);
+        painter.fillRect(bar, (i < 16) ? QColor(96, 200, 96) : (i < 33) ? QColor(230, 200, 64) : QColor(230, 80, 64));
+    }
+
+    // 60 FPS frame budget
+    const qreal budgetX = Margin + 16.7 * bucketWidth;
+    painter.setPen(QColor(255, 255, 255, 128));
+    painter.drawLine(QPointF(budgetX, y), QPointF(budgetX, y + HistogramHeight));
+}
@@ -0,0 +1,27 @@
+#ifndef FRAMEPROFILEROVERLAY_H
+#define FRAMEPROFILEROVERLAY_H
+
+#include <QWidget>
+
+// HUD on top of a CEGUI view that shows recent frame timings collected by FrameProfiler:
+// per-scope averages and a histogram of frame times. Refreshed a few times per second, not each frame,
+// so it doesn't distort measurements and doesn't cause repaints of the view itself.
+
+class QTimer;
+
+class FrameProfilerOverlay : public QWidget
+{
+public:
+
+    explicit FrameProfilerOverlay(QWidget* parent = nullptr);
+
+protected:
+
+    virtual void showEvent(QShowEvent* event) override;
+    virtual void hideEvent(QHideEvent* event) override;
+    virtual void paintEvent(QPaintEvent* event) override;
+
+    QTimer* _refreshTimer = nullptr;
+};
+
+#endif // FRAMEPROFILEROVERLAY_H
@@ -1298,6 +1298,44 @@ bool MainWindow::on_actionCloseProject_triggered()
 
 void MainWindow::on_actionReloadResources_triggered()
 {
+    // Try to reload only changed resources, editors supporting it remain opened
+    auto& ceguiManager = CEGUIManager::Instance();
+    const auto changes = ceguiManager.detectChangedResources();
+    if (changes == CEGUIManager::ResourceChanges::None)
+    {
+        setStatusMessage("All project resources are up to date");
+        return;
+    }
+    else if (changes == CEGUIManager::ResourceChanges::Partial)
+    {
+        std::vector<EditorBase*> releasedEditors;
+        bool canReload = true;
+        for (int i = 0; i < ui->tabs->count(); ++i)
+        {
+            auto editor = getEditorForTab(i);
+            if (!editor->requiresProject()) continue;
+
+            if (!editor->releaseProjectResources())
+            {
+                canReload = false;
+                break;
+            }
+
+            releasedEditors.push_back(editor);
+        }
+
+        if (canReload) ceguiManager.reloadChangedResources();
+
+        for (auto editor : releasedEditors)
+            editor->restoreProjectResources();
+
+        if (canReload)
+        {
+            setStatusMessage("Changed project resources reloaded");
+            return;
+        }
+    }
+
     // Since we are effectively unloading the project and potentially nuking resources of it
     // we should definitely unload all tabs that rely on it to prevent segfaults and other
     // nasty phenomena
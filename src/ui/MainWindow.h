@@ -39,6 +39,7 @@ public:
     void setStatusMessage(const QString& msg);
 
     void loadProject(const QString& path);
+    void closeEditorTab(EditorBase* editor);
 
     // Common actions
     QAction* getActionCut() const;
@@ -138,7 +139,6 @@ private:
     EditorBasePtr createEditorForFile(const QString& absolutePath);
     void initEditor(EditorBasePtr editor);
     bool activateEditorTabByFilePath(const QString& absolutePath);
-    void closeEditorTab(EditorBase* editor);
     bool closeAllTabsRequiringProject();
     EditorBase* getEditorForTab(int index) const;
     EditorBase* getEditorForTab(QWidget* tabWidget) const;
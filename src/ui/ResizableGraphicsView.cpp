@@ -25,19 +25,41 @@ ResizableGraphicsView::ResizableGraphicsView(QWidget *parent)
     helpLabel->setVisible(false);
 }
 
+// Only visible and selected items are updated, others get the scale lazily, see ResizableRectItem::updateScale
 void ResizableGraphicsView::setTransform(const QTransform& transform)
 {
     QGraphicsView::setTransform(transform);
 
-    const qreal scaleX = transform.m11();
-    const qreal scaleY = transform.m22();
+    if (!scene()) return;
 
-    // Handle scale change
-    for (auto& item : scene()->items())
-    {
-        auto rectItem = dynamic_cast<ResizableRectItem*>(item);
-        if (rectItem) rectItem->onScaleChanged(scaleX, scaleY);
-    }
+    for (QGraphicsItem* item : scene()->selectedItems())
+        if (auto rectItem = dynamic_cast<ResizableRectItem*>(item))
+            rectItem->updateScale(transform.m11(), transform.m22());
+
+    updateVisibleItemsScale();
+}
+
+void ResizableGraphicsView::updateVisibleItemsScale()
+{
+    if (!scene()) return;
+
+    const qreal scaleX = transform().m11();
+    const qreal scaleY = transform().m22();
+    for (QGraphicsItem* item : items(viewport()->rect()))
+        if (auto rectItem = dynamic_cast<ResizableRectItem*>(item))
+            rectItem->updateScale(scaleX, scaleY);
+}
+
+void ResizableGraphicsView::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    updateVisibleItemsScale();
+}
+
+void ResizableGraphicsView::resizeEvent(QResizeEvent* event)
+{
+    QGraphicsView::resizeEvent(event);
+    updateVisibleItemsScale();
 }
 
 void ResizableGraphicsView::zoomIn()
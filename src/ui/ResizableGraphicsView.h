@@ -48,6 +48,11 @@ signals:
 
 protected:
 
+    void updateVisibleItemsScale();
+
+    virtual void scrollContentsBy(int dx, int dy) override;
+    virtual void resizeEvent(QResizeEvent* event) override;
+
     QLabel* helpLabel = nullptr;
 
     QPoint lastDragScrollMousePosition;
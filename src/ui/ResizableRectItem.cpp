@@ -2,6 +2,8 @@
 #include "src/ui/ResizingHandle.h"
 #include <qcursor.h>
 #include <qpen.h>
+#include <qgraphicsscene.h>
+#include <qgraphicsview.h>
 #include <cmath>
 
 ResizableRectItem::ResizableRectItem(QGraphicsItem* parent)
@@ -246,28 +248,36 @@ QPen ResizableRectItem::getPenWhileMoving() const
     return ret;
 }
 
+// Views don't update all items on zoom, only visible and selected ones. Others get the actual scale
+// when they become visible or interactive, so the handle layout must never be relied on without that.
+void ResizableRectItem::updateScale(qreal scaleX, qreal scaleY)
+{
+    if (scaleX != _currentScaleX || scaleY != _currentScaleY)
+        onScaleChanged(scaleX, scaleY);
+}
+
+void ResizableRectItem::updateScaleFromView()
+{
+    if (!scene() || scene()->views().empty()) return;
+
+    const QTransform transform = scene()->views().front()->transform();
+    updateScale(transform.m11(), transform.m22());
+}
+
+// Child resizables are not updated here, they receive the scale from the view independently
 void ResizableRectItem::onScaleChanged(qreal scaleX, qreal scaleY)
 {
     _currentScaleX = scaleX;
     _currentScaleY = scaleY;
 
-    const auto children = childItems();
-    for (QGraphicsItem* item : children)
-    {
-        ResizingHandle* handle = dynamic_cast<ResizingHandle*>(item);
-        if (handle)
-        {
-            handle->onScaleChanged(scaleX, scaleY);
-            continue;
-        }
-
-        ResizableRectItem* rectItem = dynamic_cast<ResizableRectItem*>(item);
-        if (rectItem)
-        {
-            rectItem->onScaleChanged(scaleX, scaleY);
-            continue;
-        }
-    }
+    topEdgeHandle->onScaleChanged(scaleX, scaleY);
+    bottomEdgeHandle->onScaleChanged(scaleX, scaleY);
+    leftEdgeHandle->onScaleChanged(scaleX, scaleY);
+    rightEdgeHandle->onScaleChanged(scaleX, scaleY);
+    topRightCornerHandle->onScaleChanged(scaleX, scaleY);
+    bottomRightCornerHandle->onScaleChanged(scaleX, scaleY);
+    bottomLeftCornerHandle->onScaleChanged(scaleX, scaleY);
+    topLeftCornerHandle->onScaleChanged(scaleX, scaleY);
 
     _handlesDirty = true;
     updateHandles();
@@ -363,6 +373,7 @@ QVariant ResizableRectItem::itemChange(GraphicsItemChange change, const QVariant
     {
         if (value.toBool())
         {
+            updateScaleFromView();
             deselectAllHandles();
         }
         else
@@ -384,12 +395,18 @@ QVariant ResizableRectItem::itemChange(GraphicsItemChange change, const QVariant
             return pos() + delta;
         }
     }
+    else if (change == ItemSceneHasChanged)
+    {
+        // Items created after zooming would have handles laid out for the default scale
+        updateScaleFromView();
+    }
 
     return QGraphicsRectItem::itemChange(change, value);
 }
 
 void ResizableRectItem::hoverEnterEvent(QGraphicsSceneHoverEvent* event)
 {
+    updateScaleFromView();
     QGraphicsRectItem::hoverEnterEvent(event);
     setPen(getHoverPen());
     _mouseOver = true;
@@ -40,6 +40,8 @@ public:
     virtual QSizeF getMinSize() const { return QSizeF(1.0, 1.0); }
     virtual QSizeF getMaxSize() const { return QSizeF(std::numeric_limits<qreal>().max(), std::numeric_limits<qreal>().max()); }
 
+    void updateScale(qreal scaleX, qreal scaleY);
+    void updateScaleFromView();
     virtual void onScaleChanged(qreal scaleX, qreal scaleY);
     void mouseReleaseEventSelected();
 
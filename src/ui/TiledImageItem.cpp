@@ -0,0 +1,188 @@
+#include "src/ui/TiledImageItem.h"
+#include "src/util/FunctionTask.h"
+#include "qpainter.h"
+#include "qstyleoption.h"
+#include <algorithm>
+#include <cmath>
+
+static const int TileSize = 256;
+static const int MaxTileCacheCostKB = 64 * 1024; // Enough for all tiles of a 4K viewport at one level, with margin
+static const int MaxTileRequestsPerPaint = 256; // Prevents requesting thousands of full resolution tiles while zoomed out
+
+TiledImageItem::TiledImageItem(QGraphicsItem* parent)
+    : QGraphicsObject(parent)
+    , _tiles(MaxTileCacheCostKB)
+    , _generation(0)
+{
+    setFlags(ItemUsesExtendedStyleOption);
+
+    connect(this, &TiledImageItem::tileReady, this, &TiledImageItem::onTileReady, Qt::QueuedConnection);
+}
+
+TiledImageItem::~TiledImageItem()
+{
+    cancelTasks();
+}
+
+void TiledImageItem::setImage(const QImage& image)
+{
+    cancelTasks();
+
+    prepareGeometryChange();
+
+    _tiles.clear();
+    _pendingTiles.clear();
+    _levelSizes.clear();
+    _image = image;
+
+    if (image.isNull()) return;
+
+    QSize levelSize = image.size();
+    _levelSizes.push_back(levelSize);
+    while (std::max(levelSize.width(), levelSize.height()) > TileSize)
+    {
+        levelSize = QSize((levelSize.width() + 1) / 2, (levelSize.height() + 1) / 2);
+        _levelSizes.push_back(levelSize);
+    }
+}
+
+QRectF TiledImageItem::boundingRect() const
+{
+    return QRectF(QPointF(0.0, 0.0), QSizeF(_image.size()));
+}
+
+void TiledImageItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* /*widget*/)
+{
+    if (_levelSizes.empty()) return;
+
+    // Choose the coarsest level that still has at least one texel per screen pixel
+    const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    int level = 0;
+    while (level + 1 < static_cast<int>(_levelSizes.size()) && lod * (1 << (level + 1)) <= 1.0)
+        ++level;
+
+    const QSize& levelSize = _levelSizes[static_cast<size_t>(level)];
+    const qreal scaleX = static_cast<qreal>(_image.width()) / levelSize.width();
+    const qreal scaleY = static_cast<qreal>(_image.height()) / levelSize.height();
+    const int tilesX = (levelSize.width() + TileSize - 1) / TileSize;
+    const int tilesY = (levelSize.height() + TileSize - 1) / TileSize;
+
+    const QRectF exposedRect = option->exposedRect & boundingRect();
+    if (exposedRect.isEmpty()) return;
+
+    const int firstX = std::max(0, static_cast<int>(std::floor(exposedRect.left() / scaleX / TileSize)));
+    const int firstY = std::max(0, static_cast<int>(std::floor(exposedRect.top() / scaleY / TileSize)));
+    const int lastX = std::min(tilesX, static_cast<int>(std::ceil(exposedRect.right() / scaleX / TileSize))) - 1;
+    const int lastY = std::min(tilesY, static_cast<int>(std::ceil(exposedRect.bottom() / scaleY / TileSize))) - 1;
+    const bool canRequest = (lastX - firstX + 1) * (lastY - firstY + 1) <= MaxTileRequestsPerPaint;
+
+    const bool oldSmooth = painter->testRenderHint(QPainter::SmoothPixmapTransform);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, lod < 1.0);
+
+    for (int y = firstY; y <= lastY; ++y)
+    {
+        for (int x = firstX; x <= lastX; ++x)
+        {
+            if (QPixmap* tile = _tiles.object(getTileKey(level, x, y)))
+            {
+                painter->drawPixmap(getTileRect(level, x, y), *tile, QRectF(tile->rect()));
+                continue;
+            }
+
+            if (canRequest) requestTile(level, x, y);
+            drawFallbackTile(painter, level, x, y);
+        }
+    }
+
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, oldSmooth);
+}
+
+void TiledImageItem::onTileReady(int generation, quint64 key, QImage tile)
+{
+    if (generation != _generation) return;
+
+    _pendingTiles.erase(key);
+    _tiles.insert(key, new QPixmap(QPixmap::fromImage(tile)), std::max(1, tile.width() * tile.height() * 4 / 1024));
+
+    const int level = static_cast<int>(key >> 56);
+    const int x = static_cast<int>((key >> 28) & 0xfffffff);
+    const int y = static_cast<int>(key & 0xfffffff);
+    update(getTileRect(level, x, y));
+}
+
+quint64 TiledImageItem::getTileKey(int level, int x, int y)
+{
+    return (static_cast<quint64>(level) << 56) | (static_cast<quint64>(x) << 28) | static_cast<quint64>(y);
+}
+
+// Rect of the tile in item coordinates, which are pixels of the source image
+QRectF TiledImageItem::getTileRect(int level, int x, int y) const
+{
+    const QSize& levelSize = _levelSizes[static_cast<size_t>(level)];
+    const qreal scaleX = static_cast<qreal>(_image.width()) / levelSize.width();
+    const qreal scaleY = static_cast<qreal>(_image.height()) / levelSize.height();
+    const int width = std::min(TileSize, levelSize.width() - x * TileSize);
+    const int height = std::min(TileSize, levelSize.height() - y * TileSize);
+    return QRectF(x * TileSize * scaleX, y * TileSize * scaleY, width * scaleX, height * scaleY);
+}
+
+// Stretches a part of the nearest cached coarser tile over the missing one, so that zooming shows
+// a blurry image instead of holes while tiles are being prepared
+bool TiledImageItem::drawFallbackTile(QPainter* painter, int level, int x, int y) const
+{
+    const QRectF targetRect = getTileRect(level, x, y);
+
+    for (int coarseLevel = level + 1; coarseLevel < static_cast<int>(_levelSizes.size()); ++coarseLevel)
+    {
+        const int shift = coarseLevel - level;
+        const int coarseX = x >> shift;
+        const int coarseY = y >> shift;
+        QPixmap* tile = _tiles.object(getTileKey(coarseLevel, coarseX, coarseY));
+        if (!tile) continue;
+
+        const QRectF coarseRect = getTileRect(coarseLevel, coarseX, coarseY);
+        const qreal scaleX = coarseRect.width() / tile->width();
+        const qreal scaleY = coarseRect.height() / tile->height();
+        const QRectF sourceRect((targetRect.left() - coarseRect.left()) / scaleX,
+                                (targetRect.top() - coarseRect.top()) / scaleY,
+                                targetRect.width() / scaleX,
+                                targetRect.height() / scaleY);
+        painter->drawPixmap(targetRect, *tile, sourceRect);
+        return true;
+    }
+
+    return false;
+}
+
+// Coarse tiles are downscaled directly from the source, so that no intermediate levels are kept in memory.
+// A tile of level N reads a (TileSize << N) square of the source, which is done once until it leaves the cache.
+void TiledImageItem::requestTile(int level, int x, int y)
+{
+    const quint64 key = getTileKey(level, x, y);
+    if (!_pendingTiles.insert(key).second) return;
+
+    // QImage is implicitly shared, the worker only reads its own reference to the source
+    const QImage image = _image;
+    const QRectF tileRect = getTileRect(level, x, y);
+    const QRect sourceRect = tileRect.toAlignedRect() & image.rect();
+    const QSize& levelSize = _levelSizes[static_cast<size_t>(level)];
+    const QSize tileSize(std::min(TileSize, levelSize.width() - x * TileSize), std::min(TileSize, levelSize.height() - y * TileSize));
+    const int generation = _generation;
+    _pool.start(new FunctionTask([this, image, sourceRect, tileSize, key, generation]()
+    {
+        if (_generation != generation) return;
+
+        QImage tile = image.copy(sourceRect);
+        if (tile.size() != tileSize)
+            tile = tile.scaled(tileSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        emit tileReady(generation, key, tile);
+    }));
+}
+
+// Results of running tasks are discarded by the generation check, so we wait only for the current step of each
+void TiledImageItem::cancelTasks()
+{
+    ++_generation;
+    _pool.clear();
+    _pool.waitForDone();
+}
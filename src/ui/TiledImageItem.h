@@ -0,0 +1,57 @@
+#ifndef TILEDIMAGEITEM_H
+#define TILEDIMAGEITEM_H
+
+#include "qgraphicsitem.h"
+#include "qimage.h"
+#include "qcache.h"
+#include "qthreadpool.h"
+#include <unordered_set>
+#include <vector>
+#include <atomic>
+
+// Displays a potentially huge image as a grid of tiles. Each paint uses the mip level closest to the current
+// zoom, so zooming out doesn't scale the full resolution image every frame. Only tiles intersecting the exposed
+// rect are drawn. Levels are not stored, each tile is cut and downscaled from the source image in a worker thread
+// on the first request and is kept in a bounded cache. Until a tile arrives the nearest cached coarser tile is
+// stretched in its place. The source image is implicitly shared with the owner, the item adds only the cache.
+
+class TiledImageItem : public QGraphicsObject
+{
+    Q_OBJECT
+
+public:
+
+    TiledImageItem(QGraphicsItem* parent = nullptr);
+    virtual ~TiledImageItem() override;
+
+    void setImage(const QImage& image);
+    const QImage& getImage() const { return _image; }
+
+    virtual QRectF boundingRect() const override;
+    virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+signals:
+
+    void tileReady(int generation, quint64 key, QImage tile);
+
+protected slots:
+
+    void onTileReady(int generation, quint64 key, QImage tile);
+
+protected:
+
+    static quint64 getTileKey(int level, int x, int y);
+    QRectF getTileRect(int level, int x, int y) const;
+    bool drawFallbackTile(QPainter* painter, int level, int x, int y) const;
+    void requestTile(int level, int x, int y);
+    void cancelTasks();
+
+    QImage _image;
+    std::vector<QSize> _levelSizes; // Level 0 is the source image, each next one is two times smaller
+    QCache<quint64, QPixmap> _tiles;
+    std::unordered_set<quint64> _pendingTiles;
+    QThreadPool _pool;
+    std::atomic<int> _generation; // Results of tasks started for a previous image are discarded
+};
+
+#endif // TILEDIMAGEITEM_H
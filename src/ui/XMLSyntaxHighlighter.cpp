@@ -1,4 +1,15 @@
 #include "src/ui/XMLSyntaxHighlighter.h"
+#include "qtextdocument.h"
+#include "qtimer.h"
+#include <algorithm>
+
+// Time budget for highlighting in one go, keeps UI responsive while the document is being highlighted
+static const qint64 SliceTimeMsec = 10;
+
+static inline bool isNameChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == '_' || c == '-' || c == '.' || c == ':';
+}
 
 XMLSyntaxHighlighter::XMLSyntaxHighlighter(QObject* parent)
     : QSyntaxHighlighter(parent)
@@ -15,38 +26,252 @@ XMLSyntaxHighlighter::XMLSyntaxHighlighter(QTextDocument* parent)
 void XMLSyntaxHighlighter::init()
 {
     // TODO: some fail colour highlighting :D please someone change the colours
-    QTextCharFormat keywordFormat;
-    keywordFormat.setFontWeight(QFont::Bold);
-    keywordFormat.setForeground(Qt::darkCyan);
+    _markupFormat.setFontWeight(QFont::Bold);
+    _markupFormat.setForeground(Qt::darkCyan);
+
+    _elementNameFormat.setFontWeight(QFont::Bold);
+    _elementNameFormat.setForeground(Qt::darkCyan);
+
+    _attributeNameFormat.setFontItalic(true);
+    _attributeNameFormat.setForeground(Qt::blue);
+
+    _attributeValueFormat.setForeground(Qt::darkRed);
+
+    _commentFormat.setFontItalic(true);
+    _commentFormat.setForeground(Qt::darkGreen);
+
+    _cdataFormat.setForeground(Qt::darkGray);
+
+    _idleTimer = new QTimer(this);
+    _idleTimer->setSingleShot(true);
+    _idleTimer->setInterval(0);
+    connect(_idleTimer, &QTimer::timeout, this, &XMLSyntaxHighlighter::highlightPendingBlocks);
+
+    // Edits before pending blocks shift their numbers
+    if (auto doc = document())
+    {
+        connect(doc, &QTextDocument::contentsChange, this, [this, doc](int position, int /*charsRemoved*/, int /*charsAdded*/)
+        {
+            if (_nextPendingBlock >= 0)
+                _nextPendingBlock = std::min(_nextPendingBlock, doc->findBlock(position).blockNumber());
+        });
+    }
+}
+
+// Returns false if the current slice is out of time and the block must be postponed
+bool XMLSyntaxHighlighter::startSlice()
+{
+    // Qt highlights changed blocks synchronously, a slice lasts until we return to the event loop
+    if (!_sliceActive)
+    {
+        _sliceActive = true;
+        _sliceExpired = false;
+        _sliceTimer.start();
+        _idleTimer->start();
+    }
+
+    if (!_sliceExpired && _sliceTimer.elapsed() > SliceTimeMsec)
+        _sliceExpired = true;
 
-    highlightingRules.emplace_back(QRegularExpression("\\b?xml\\b"), keywordFormat);
-    highlightingRules.emplace_back(QRegularExpression("/>"), keywordFormat);
-    highlightingRules.emplace_back(QRegularExpression(">"), keywordFormat);
-    highlightingRules.emplace_back(QRegularExpression("</"), keywordFormat);
-    highlightingRules.emplace_back(QRegularExpression("<"), keywordFormat);
+    return !_sliceExpired;
+}
+
+void XMLSyntaxHighlighter::highlightPendingBlocks()
+{
+    _sliceActive = false;
+
+    if (_nextPendingBlock < 0 || !document()) return;
+
+    // Find the first block that wasn't highlighted. Blocks before it are valid.
+    QTextBlock block = document()->findBlockByNumber(_nextPendingBlock);
+    while (block.isValid() && block.userState() != StatePending)
+        block = block.next();
 
-    QTextCharFormat elementNameFormat;
-    elementNameFormat.setFontWeight(QFont::Bold);
-    elementNameFormat.setForeground(Qt::darkCyan);
+    _nextPendingBlock = -1;
+    if (!block.isValid()) return;
 
-    highlightingRules.emplace_back(QRegularExpression("\\b[A-Za-z0-9_]+(?=[\\s/>])"), elementNameFormat);
+    // Qt continues to the next blocks while their state changes, pending blocks always change it.
+    // When the slice expires, the rest is postponed and _nextPendingBlock is set again.
+    const int blockNumber = block.blockNumber();
+    rehighlightBlock(block);
+
+    // Qt stops on a block whose state didn't change, there may be pending blocks after it
+    if (_nextPendingBlock < 0) _nextPendingBlock = blockNumber + 1;
+
+    _sliceActive = false;
+    _idleTimer->start();
+}
+
+// Formats text up to and including the terminator. Returns the position after it or -1 if not found in this block.
+int XMLSyntaxHighlighter::highlightUntil(const QString& text, int from, const QString& terminator, const QTextCharFormat& format)
+{
+    const int end = text.indexOf(terminator, from);
+    if (end < 0)
+    {
+        setFormat(from, text.size() - from, format);
+        return -1;
+    }
 
-    QTextCharFormat attributeKeyFormat;
-    attributeKeyFormat.setFontItalic(true);
-    attributeKeyFormat.setForeground(Qt::blue);
-    highlightingRules.emplace_back(QRegularExpression("\\b[A-Za-z0-9_]+(?=\\=)"), attributeKeyFormat);
+    const int next = end + terminator.size();
+    setFormat(from, next - from, format);
+    return next;
 }
 
 void XMLSyntaxHighlighter::highlightBlock(const QString& text)
 {
-    for (auto&& pair : highlightingRules)
+    // We can't know where we are if the previous block wasn't highlighted yet
+    const int prevState = previousBlockState();
+    if (prevState == StatePending || !startSlice())
+    {
+        setCurrentBlockState(StatePending);
+        const int blockNumber = currentBlock().blockNumber();
+        if (_nextPendingBlock < 0 || blockNumber < _nextPendingBlock)
+            _nextPendingBlock = blockNumber;
+        return;
+    }
+
+    int state = std::max(prevState, static_cast<int>(StateText));
+    const int length = text.size();
+    int i = 0;
+    while (i < length)
     {
-        auto it = pair.first.globalMatch(text);
-        while (it.hasNext())
+        switch (state)
         {
-            QRegularExpressionMatch match = it.next();
-            if (match.hasMatch())
-                setFormat(match.capturedStart(), match.capturedLength(), pair.second);
+            case StateText:
+            {
+                const int start = text.indexOf('<', i);
+                if (start < 0)
+                {
+                    i = length;
+                    break;
+                }
+
+                const QStringRef rest = text.midRef(start);
+                if (rest.startsWith("<!--"))
+                {
+                    state = StateComment;
+                    setFormat(start, 4, _commentFormat);
+                    i = start + 4;
+                }
+                else if (rest.startsWith("<![CDATA["))
+                {
+                    state = StateCData;
+                    setFormat(start, 9, _markupFormat);
+                    i = start + 9;
+                }
+                else if (rest.startsWith("<?"))
+                {
+                    state = StateInstruction;
+                    i = start;
+                }
+                else if (rest.startsWith("<!"))
+                {
+                    state = StateDeclaration;
+                    i = start;
+                }
+                else
+                {
+                    // Start or end tag followed by an element name
+                    int nameStart = start + 1;
+                    if (nameStart < length && text[nameStart] == '/') ++nameStart;
+                    setFormat(start, nameStart - start, _markupFormat);
+
+                    int nameEnd = nameStart;
+                    while (nameEnd < length && isNameChar(text[nameEnd])) ++nameEnd;
+                    setFormat(nameStart, nameEnd - nameStart, _elementNameFormat);
+
+                    state = StateTag;
+                    i = nameEnd;
+                }
+                break;
+            }
+            case StateTag:
+            {
+                const QChar c = text[i];
+                if (c == '>')
+                {
+                    setFormat(i, 1, _markupFormat);
+                    state = StateText;
+                    ++i;
+                }
+                else if (c == '/' && i + 1 < length && text[i + 1] == '>')
+                {
+                    setFormat(i, 2, _markupFormat);
+                    state = StateText;
+                    i += 2;
+                }
+                else if (c == '"' || c == '\'')
+                {
+                    state = (c == '"') ? StateAttributeValueDoubleQuoted : StateAttributeValueSingleQuoted;
+                    setFormat(i, 1, _attributeValueFormat);
+                    ++i;
+                }
+                else if (isNameChar(c))
+                {
+                    int nameEnd = i + 1;
+                    while (nameEnd < length && isNameChar(text[nameEnd])) ++nameEnd;
+                    setFormat(i, nameEnd - i, _attributeNameFormat);
+                    i = nameEnd;
+                }
+                else
+                {
+                    ++i;
+                }
+                break;
+            }
+            case StateAttributeValueDoubleQuoted:
+            case StateAttributeValueSingleQuoted:
+            {
+                const QString quote(QChar((state == StateAttributeValueDoubleQuoted) ? '"' : '\''));
+                i = highlightUntil(text, i, quote, _attributeValueFormat);
+                if (i >= 0) state = StateTag;
+                break;
+            }
+            case StateComment:
+            {
+                i = highlightUntil(text, i, "-->", _commentFormat);
+                if (i >= 0) state = StateText;
+                break;
+            }
+            case StateCData:
+            {
+                const int end = text.indexOf("]]>", i);
+                if (end < 0)
+                {
+                    setFormat(i, length - i, _cdataFormat);
+                    i = -1;
+                }
+                else
+                {
+                    setFormat(i, end - i, _cdataFormat);
+                    setFormat(end, 3, _markupFormat);
+                    state = StateText;
+                    i = end + 3;
+                }
+                break;
+            }
+            case StateInstruction:
+            {
+                i = highlightUntil(text, i, "?>", _markupFormat);
+                if (i >= 0) state = StateText;
+                break;
+            }
+            case StateDeclaration:
+            {
+                i = highlightUntil(text, i, ">", _markupFormat);
+                if (i >= 0) state = StateText;
+                break;
+            }
+            default:
+            {
+                state = StateText;
+                break;
+            }
         }
+
+        // The construct continues in the next block
+        if (i < 0) break;
     }
+
+    setCurrentBlockState(state);
 }
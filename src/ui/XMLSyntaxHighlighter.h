@@ -2,7 +2,13 @@
 #define XMLSYNTAXHIGHLIGHTER_H
 
 #include "qsyntaxhighlighter.h"
-#include "qregularexpression.h"
+#include "qelapsedtimer.h"
+
+// Single pass XML highlighter. Constructs spanning multiple lines (comments, CDATA, tags with attributes)
+// are tracked through the block state. Highlighting is time sliced: when a single change (e.g. loading
+// a huge document) takes too long, remaining blocks are marked pending and highlighted on idle in chunks.
+
+class QTimer;
 
 class XMLSyntaxHighlighter : public QSyntaxHighlighter
 {
@@ -13,11 +19,38 @@ public:
 
 protected:
 
+    enum State
+    {
+        StatePending = -2, // Not highlighted yet
+        StateText = 0,
+        StateTag, // Inside a tag after its name
+        StateAttributeValueDoubleQuoted,
+        StateAttributeValueSingleQuoted,
+        StateComment,
+        StateCData,
+        StateInstruction,
+        StateDeclaration
+    };
+
     void init();
+    bool startSlice();
+    void highlightPendingBlocks();
+    int highlightUntil(const QString& text, int from, const QString& terminator, const QTextCharFormat& format);
 
     virtual void highlightBlock(const QString& text) override;
 
-    std::vector<std::pair<QRegularExpression, QTextCharFormat>> highlightingRules;
+    QTextCharFormat _markupFormat;
+    QTextCharFormat _elementNameFormat;
+    QTextCharFormat _attributeNameFormat;
+    QTextCharFormat _attributeValueFormat;
+    QTextCharFormat _commentFormat;
+    QTextCharFormat _cdataFormat;
+
+    QTimer* _idleTimer = nullptr;
+    QElapsedTimer _sliceTimer;
+    int _nextPendingBlock = -1;
+    bool _sliceActive = false;
+    bool _sliceExpired = false;
 };
 
 #endif // XMLSYNTAXHIGHLIGHTER_H
@@ -10,7 +10,6 @@
 #include "qstatusbar.h"
 #include "qdom.h"
 #include "qpainter.h"
-#include "qlistwidget.h"
 
 ImageEntry::ImageEntry(QGraphicsItem* parent)
     : ResizableRectItem(parent)
@@ -29,12 +28,6 @@ ImageEntry::ImageEntry(QGraphicsItem* parent)
 
 ImageEntry::~ImageEntry()
 {
-    if (listItem)
-    {
-        listItem->setData(Qt::UserRole + 2, QVariant());
-        listItem = nullptr;
-        //???or delete list item?
-    }
 }
 
 // We simply round the rectangle because we only support "full" pixels
@@ -120,12 +113,10 @@ void ImageEntry::saveToElement(QDomElement& xml)
 // If we are selected in the dock widget, this updates the property box
 void ImageEntry::updateDockWidget()
 {
-    if (!listItem) return;
+    if (!dockWidget) return;
 
     updateListItem();
 
-    // TODO: redesign?
-    auto dockWidget = listItem->data(Qt::UserRole + 1).value<ImagesetEditorDockWidget*>();
     if (dockWidget->getActiveImageEntry() == this)
         dockWidget->refreshActiveImageEntry();
 }
@@ -133,30 +124,7 @@ void ImageEntry::updateDockWidget()
 // Updates the list item associated with this image entry in the dock widget
 void ImageEntry::updateListItem()
 {
-    if (!listItem) return;
-
-    listItem->setText(name());
-
-    QPixmap pixmap = getPixmap();
-    if (pixmap.isNull())
-    {
-        listItem->setIcon(QIcon());
-    }
-    else
-    {
-        constexpr int previewWidth = 24;
-        constexpr int previewHeight = 24;
-
-        QPixmap preview(previewWidth, previewHeight);
-        QPainter painter(&preview);
-        painter.setBrush(Utils::getCheckerboardBrush());
-        painter.drawRect(0, 0, previewWidth, previewHeight);
-        QPixmap scaledPixmap = getPixmap().scaled(QSize(previewWidth, previewHeight), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        painter.drawPixmap((previewWidth - scaledPixmap.width()) / 2, (previewHeight - scaledPixmap.height()) / 2, scaledPixmap);
-        painter.end();
-
-        listItem->setIcon(QIcon(preview));
-    }
+    if (dockWidget) dockWidget->updateImageEntryItem(this);
 }
 
 void ImageEntry::showLabel(bool show)
@@ -171,7 +139,13 @@ QString ImageEntry::name() const
 
 void ImageEntry::setName(const QString& newName)
 {
+    const QString oldName = name();
+    if (oldName == newName) return;
+
     label->setPlainText(newName);
+
+    if (auto imagesetEntry = dynamic_cast<ImagesetEntry*>(parentItem()))
+        imagesetEntry->onImageEntryRenamed(this, oldName);
 }
 
 int ImageEntry::offsetX() const
@@ -285,7 +259,7 @@ QVariant ImageEntry::itemChange(GraphicsItemChange change, const QVariant& value
 
         // If, for whatever reason, the loading of the pixmap failed, we don't constrain to the empty null pixmap
         ImagesetEntry* imagesetEntry = static_cast<ImagesetEntry*>(parentItem());
-        if (!imagesetEntry->pixmap().isNull())
+        if (imagesetEntry->hasImage())
         {
             auto parentRect = imagesetEntry->boundingRect();
             parentRect.setWidth(parentRect.width() - rect().width());
@@ -351,32 +325,25 @@ void ImageEntry::onPotentialMove(bool move)
 
 // Creates and returns a pixmap containing what's in the underlying image in the rectangle
 // that this ImageEntry has set. This is mostly used for preview thumbnails in the dock widget.
-QPixmap ImageEntry::getPixmap()
+// Part of the imageset image covered by this entry, in image pixels
+QRect ImageEntry::getImageRect() const
 {
-    ImagesetEntry* imagesetEntry = static_cast<ImagesetEntry*>(parentItem());
-
-    if (!imagesetEntry || imagesetEntry->pixmap().isNull())
-        return QPixmap();
-
-    return imagesetEntry->pixmap().copy(
-                static_cast<int>(pos().x()),
-                static_cast<int>(pos().y()),
-                static_cast<int>(rect().width()),
-                static_cast<int>(rect().height()));
+    return QRect(static_cast<int>(pos().x()),
+                 static_cast<int>(pos().y()),
+                 static_cast<int>(rect().width()),
+                 static_cast<int>(rect().height()));
 }
 
 // Synchronises the selection in the dock widget's list. This makes sure that when you select
 // this item the list sets the selection to this item as well.
 void ImageEntry::updateListItemSelection()
 {
-    if (!listItem) return;
-
-    auto dockWidget = listItem->data(Qt::UserRole + 1).value<ImagesetEditorDockWidget*>();
+    if (!dockWidget) return;
 
     // The dock widget itself is performing a selection, we shall not interfere
     if (dockWidget->isSelectionUnderway()) return;
 
     dockWidget->setSelectionSynchronizationUnderway(true);
-    listItem->setSelected(isSelected() || isAnyHandleSelected() || offset->isSelected());
+    dockWidget->setImageEntrySelected(this, isSelected() || isAnyHandleSelected() || offset->isSelected());
     dockWidget->setSelectionSynchronizationUnderway(false);
 }
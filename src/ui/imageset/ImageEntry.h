@@ -6,7 +6,7 @@
 // Represents the image of the imageset, can be drag moved, selected, resized, ...
 
 class QDomElement;
-class QListWidgetItem;
+class ImagesetEditorDockWidget;
 class ImageLabel;
 class ImageOffsetMark;
 
@@ -27,10 +27,10 @@ public:
 
     void updateDockWidget();
     void updateListItem();
-    void setListItem(QListWidgetItem* newItem) { listItem = newItem; }
-    QListWidgetItem* getListItem() const { return listItem; }
+    void setDockWidget(ImagesetEditorDockWidget* widget) { dockWidget = widget; }
     ImageOffsetMark* getOffsetMark() const { return offset; }
     void showLabel(bool show);
+    QRect getImageRect() const;
 
     QString name() const;
     void setName(const QString& newName);
@@ -57,12 +57,11 @@ protected:
     virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
     virtual QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
 
-    QPixmap getPixmap();
     void updateListItemSelection();
 
     ImageLabel* label = nullptr;
     ImageOffsetMark* offset = nullptr;
-    QListWidgetItem* listItem = nullptr; // This allows fast updates of the list item without looking it up
+    ImagesetEditorDockWidget* dockWidget = nullptr; // Set when the dock widget lists this image
 
     QString autoScaled = "";
     int nativeHorzRes = 0;
@@ -75,6 +74,6 @@ protected:
     bool resized = false;
 };
 
-Q_DECLARE_METATYPE(ImageEntry*); // For storing in list items of the ImagesetEditorDockWidget
+Q_DECLARE_METATYPE(ImageEntry*); // For the image list model of the ImagesetEditorDockWidget
 
 #endif // IMAGEENTRY_H
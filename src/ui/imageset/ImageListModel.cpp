@@ -0,0 +1,217 @@
+#include "src/ui/imageset/ImageListModel.h"
+#include "src/ui/imageset/ImagesetEntry.h"
+#include "src/ui/imageset/ImageEntry.h"
+#include "src/util/ImageService.h"
+#include "src/util/Utils.h"
+#include "qpainter.h"
+#include <algorithm>
+
+static const int MaxCachedThumbnails = 4096;
+static const int ThumbnailWidth = 24;
+static const int ThumbnailHeight = 24;
+
+ImageListModel::ImageListModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , _thumbnails(MaxCachedThumbnails)
+{
+    connect(&ImageService::Instance(), &ImageService::thumbnailReady, this, &ImageListModel::onThumbnailReady);
+}
+
+void ImageListModel::setImagesetEntry(ImagesetEntry* entry)
+{
+    _imagesetEntry = entry;
+    reset();
+}
+
+// Must be called after image entries are added or removed
+void ImageListModel::reset()
+{
+    beginResetModel();
+
+    _thumbnails.clear();
+    _pendingThumbnails.clear();
+    _rows.clear();
+    if (_imagesetEntry)
+    {
+        const auto& entries = _imagesetEntry->getImageEntries();
+        _rows.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+            _rows.emplace(entries[i], static_cast<int>(i));
+    }
+
+    endResetModel();
+}
+
+void ImageListModel::updateImageEntry(ImageEntry* entry)
+{
+    _thumbnails.remove(entry);
+
+    const QModelIndex index = getIndex(entry);
+    if (index.isValid()) emit dataChanged(index, index);
+}
+
+ImageEntry* ImageListModel::getImageEntry(const QModelIndex& index) const
+{
+    if (!_imagesetEntry || !index.isValid()) return nullptr;
+
+    // Between removal of an image and the following reset the row may point past the end
+    const auto& entries = _imagesetEntry->getImageEntries();
+    return (static_cast<size_t>(index.row()) < entries.size()) ? entries[static_cast<size_t>(index.row())] : nullptr;
+}
+
+QModelIndex ImageListModel::getIndex(ImageEntry* entry) const
+{
+    auto it = _rows.find(entry);
+    if (it == _rows.end()) return QModelIndex();
+
+    const QModelIndex result = index(it->second);
+    return (getImageEntry(result) == entry) ? result : QModelIndex();
+}
+
+int ImageListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return static_cast<int>(_rows.size());
+}
+
+QVariant ImageListModel::data(const QModelIndex& index, int role) const
+{
+    ImageEntry* entry = getImageEntry(index);
+    if (!entry) return QVariant();
+
+    switch (role)
+    {
+        case Qt::DisplayRole:
+        case Qt::EditRole:
+            return entry->name();
+        case Qt::DecorationRole:
+            return getThumbnail(entry);
+        case ImageEntryRole:
+            return QVariant::fromValue(entry);
+        default:
+            return QVariant();
+    }
+}
+
+bool ImageListModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (role != Qt::EditRole) return false;
+
+    ImageEntry* entry = getImageEntry(index);
+    if (!entry) return false;
+
+    const QString newName = value.toString();
+    if (entry->name() == newName) return false;
+
+    // Renaming goes through the undo stack, the row is updated when the command is executed
+    emit imageRenameRequested(entry, newName);
+    return true;
+}
+
+Qt::ItemFlags ImageListModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) return Qt::NoItemFlags;
+    return Qt::ItemIsSelectable | Qt::ItemIsEditable | Qt::ItemIsEnabled;
+}
+
+// Thumbnails are generated in the ImageService thread pool, the row is updated when its thumbnail is ready
+QPixmap ImageListModel::getThumbnail(ImageEntry* entry) const
+{
+    if (QPixmap* cached = _thumbnails.object(entry)) return *cached;
+
+    // The image is still being decoded, all entries are updated when it is ready
+    if (!_imagesetEntry || !_imagesetEntry->hasImage()) return QPixmap();
+
+    const QRect imageRect = entry->getImageRect();
+    if (imageRect.isEmpty())
+    {
+        _thumbnails.insert(entry, new QPixmap());
+        return QPixmap();
+    }
+
+    auto& imageService = ImageService::Instance();
+    const QSize thumbnailSize(ThumbnailWidth, ThumbnailHeight);
+    const QString key = imageService.getThumbnailKey(_imagesetEntry->getImageFile(), imageRect, thumbnailSize);
+    const QImage scaledImage = imageService.getThumbnail(key);
+    if (scaledImage.isNull())
+    {
+        auto range = _pendingThumbnails.equal_range(key);
+        if (std::none_of(range.first, range.second, [entry](const std::pair<const QString, ImageEntry*>& pair) { return pair.second == entry; }))
+            _pendingThumbnails.emplace(key, entry);
+        imageService.requestThumbnail(key, _imagesetEntry->getImage(), imageRect, thumbnailSize);
+        return QPixmap();
+    }
+
+    QPixmap preview(ThumbnailWidth, ThumbnailHeight);
+    QPainter painter(&preview);
+    painter.setBrush(Utils::getCheckerboardBrush());
+    painter.drawRect(0, 0, ThumbnailWidth, ThumbnailHeight);
+    painter.drawImage((ThumbnailWidth - scaledImage.width()) / 2, (ThumbnailHeight - scaledImage.height()) / 2, scaledImage);
+    painter.end();
+
+    _thumbnails.insert(entry, new QPixmap(preview));
+    return preview;
+}
+
+void ImageListModel::onThumbnailReady(const QString& key)
+{
+    auto range = _pendingThumbnails.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        // Entries removed since the request are not in the model anymore
+        const QModelIndex index = getIndex(it->second);
+        if (index.isValid()) emit dataChanged(index, index, { Qt::DecorationRole });
+    }
+    _pendingThumbnails.erase(range.first, range.second);
+}
+
+//---------------------------------------------------------------------
+
+ImageListFilterModel::ImageListFilterModel(QObject* parent)
+    : QSortFilterProxyModel(parent)
+{
+    setDynamicSortFilter(true);
+}
+
+void ImageListFilterModel::setFilterPattern(const QString& pattern)
+{
+    // We append star at the beginning and at the end by default (makes property filtering much more practical),
+    // so a pattern without wildcards is just a case insensitive substring search
+    if (pattern == _pattern) return;
+
+    _pattern = pattern;
+    _useRegex = _pattern.contains(QLatin1Char('*')) || _pattern.contains(QLatin1Char('?')) || _pattern.contains(QLatin1Char('['));
+    if (_useRegex)
+    {
+        _regex.setPattern(QRegularExpression::wildcardToRegularExpression("*" + _pattern + "*"));
+        _regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        _regex.optimize();
+    }
+    else
+    {
+        _regex = QRegularExpression();
+    }
+
+    invalidateFilter();
+}
+
+bool ImageListFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    if (_pattern.isEmpty()) return true;
+
+    auto model = static_cast<ImageListModel*>(sourceModel());
+    ImageEntry* entry = model->getImageEntry(model->index(sourceRow, 0, sourceParent));
+    if (!entry) return false;
+
+    const QString name = entry->name();
+    return _useRegex ? _regex.match(name).hasMatch() : name.contains(_pattern, Qt::CaseInsensitive);
+}
+
+bool ImageListFilterModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    auto model = static_cast<ImageListModel*>(sourceModel());
+    ImageEntry* leftEntry = model->getImageEntry(left);
+    ImageEntry* rightEntry = model->getImageEntry(right);
+    if (!leftEntry || !rightEntry) return leftEntry < rightEntry;
+    return leftEntry->name() < rightEntry->name();
+}
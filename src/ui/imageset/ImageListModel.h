@@ -0,0 +1,82 @@
+#ifndef IMAGELISTMODEL_H
+#define IMAGELISTMODEL_H
+
+#include "src/QtStdHash.h"
+#include "qabstractitemmodel.h"
+#include "qsortfilterproxymodel.h"
+#include "qregularexpression.h"
+#include "qcache.h"
+#include "qpixmap.h"
+#include <unordered_map>
+
+// Image list of the imageset editor dock widget. Rows are read directly from ImagesetEntry::getImageEntries(),
+// so no per-image items are allocated. Thumbnails are requested from the ImageService on the first request from
+// the view, which means only for visible rows, and are cached until the image entry changes.
+
+class ImagesetEntry;
+class ImageEntry;
+
+class ImageListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+
+    static const int ImageEntryRole = Qt::UserRole + 1;
+
+    ImageListModel(QObject* parent = nullptr);
+
+    void setImagesetEntry(ImagesetEntry* entry);
+    void reset();
+    void updateImageEntry(ImageEntry* entry);
+
+    ImageEntry* getImageEntry(const QModelIndex& index) const;
+    QModelIndex getIndex(ImageEntry* entry) const;
+
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    virtual bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    virtual Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+signals:
+
+    void imageRenameRequested(ImageEntry* entry, const QString& newName);
+
+protected slots:
+
+    void onThumbnailReady(const QString& key);
+
+protected:
+
+    QPixmap getThumbnail(ImageEntry* entry) const;
+
+    ImagesetEntry* _imagesetEntry = nullptr;
+    std::unordered_map<const ImageEntry*, int> _rows; // Rebuilt on reset, image entries don't move otherwise
+    mutable QCache<const ImageEntry*, QPixmap> _thumbnails;
+    mutable std::unordered_multimap<QString, ImageEntry*> _pendingThumbnails; // By ImageService thumbnail key
+};
+
+// Filters and sorts the image list by name. The filter is compiled once per pattern change instead of being
+// re-evaluated from the pattern string for each row. Patterns without wildcards use a plain substring search.
+
+class ImageListFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+
+    ImageListFilterModel(QObject* parent = nullptr);
+
+    void setFilterPattern(const QString& pattern);
+
+protected:
+
+    virtual bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    virtual bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+
+    QString _pattern;
+    QRegularExpression _regex;
+    bool _useRegex = false;
+};
+
+#endif // IMAGELISTMODEL_H
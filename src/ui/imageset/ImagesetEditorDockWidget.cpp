@@ -1,6 +1,7 @@
 #include "src/ui/imageset/ImagesetEditorDockWidget.h"
 #include "src/ui/imageset/ImagesetEntry.h"
 #include "src/ui/imageset/ImageEntry.h"
+#include "src/ui/imageset/ImageListModel.h"
 #include "src/cegui/CEGUIManager.h"
 #include "src/cegui/CEGUIProject.h"
 #include "src/editors/imageset/ImagesetVisualMode.h"
@@ -10,6 +11,7 @@
 #include "qitemdelegate.h"
 #include "qvalidator.h"
 #include "qevent.h"
+#include "qtimer.h"
 
 // The only reason for this is to track when we are editing.
 // We need this to discard key events when editor is open.
@@ -73,7 +75,20 @@ ImagesetEditorDockWidget::ImagesetEditorDockWidget(ImagesetVisualMode& visualMod
             ui->btnHelp->setChecked(visible);
     });
 
+    _listModel = new ImageListModel(this);
+    _listFilterModel = new ImageListFilterModel(this);
+    _listFilterModel->setSourceModel(_listModel);
+    _listFilterModel->sort(0);
+    connect(_listModel, &ImageListModel::imageRenameRequested, this, &ImagesetEditorDockWidget::onImageRenameRequested);
+
+    ui->list->setModel(_listFilterModel);
     ui->list->setItemDelegate(new ImageEntryItemDelegate());
+    connect(ui->list->selectionModel(), &QItemSelectionModel::selectionChanged, this, &ImagesetEditorDockWidget::onListSelectionChanged);
+
+    _filterTimer = new QTimer(this);
+    _filterTimer->setSingleShot(true);
+    _filterTimer->setInterval(150);
+    connect(_filterTimer, &QTimer::timeout, this, &ImagesetEditorDockWidget::onFilterTimeout);
 
     setActiveImageEntry(nullptr);
 }
@@ -133,8 +148,6 @@ void ImagesetEditorDockWidget::refreshImagesetInfo()
 // Note: User potentially loses selection when this is called!
 void ImagesetEditorDockWidget::refresh()
 {
-    ui->list->clear();
-
     setActiveImageEntry(nullptr);
 
     assert(imagesetEntry);
@@ -142,23 +155,32 @@ void ImagesetEditorDockWidget::refresh()
     refreshImagesetInfo();
 
     for (ImageEntry* imageEntry : imagesetEntry->getImageEntries())
-    {
-        auto item = new QListWidgetItem();
-        item->setData(Qt::UserRole + 1, QVariant::fromValue(this));
-        item->setData(Qt::UserRole + 2, QVariant::fromValue(imageEntry));
-        item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEditable | Qt::ItemIsEnabled);
-        imageEntry->setListItem(item);
-        imageEntry->updateListItem(); // Nothing is selected (list was cleared) so we don't need to call the whole updateDockWidget here
-        ui->list->addItem(item);
-    }
+        imageEntry->setDockWidget(this);
 
-    // Explicitly call the filtering again to make sure it's in sync
-    on_filterBox_textChanged(ui->filterBox->text());
+    // Rows are read from the imageset entry, no list items are created. Filtering is reapplied by the proxy.
+    _listModel->setImagesetEntry(imagesetEntry);
 }
 
 void ImagesetEditorDockWidget::scrollToEntry(ImageEntry* entry)
 {
-    if (entry) ui->list->scrollToItem(entry->getListItem());
+    if (!entry) return;
+
+    const QModelIndex index = _listFilterModel->mapFromSource(_listModel->getIndex(entry));
+    if (index.isValid()) ui->list->scrollTo(index);
+}
+
+// Name or geometry of the image has changed, its row and thumbnail must be updated
+void ImagesetEditorDockWidget::updateImageEntryItem(ImageEntry* entry)
+{
+    _listModel->updateImageEntry(entry);
+}
+
+void ImagesetEditorDockWidget::setImageEntrySelected(ImageEntry* entry, bool selected)
+{
+    const QModelIndex index = _listFilterModel->mapFromSource(_listModel->getIndex(entry));
+    if (!index.isValid()) return;
+
+    ui->list->selectionModel()->select(index, selected ? QItemSelectionModel::Select : QItemSelectionModel::Deselect);
 }
 
 // Focuses into image list filter. This potentially allows the user to just press a shortcut to find images,
@@ -249,27 +271,20 @@ void ImagesetEditorDockWidget::on_autoScaledPerImage_currentIndexChanged(int ind
     onStringPropertyChanged("autoScaled", text);
 }
 
-void ImagesetEditorDockWidget::on_filterBox_textChanged(const QString& arg1)
+void ImagesetEditorDockWidget::on_filterBox_textChanged(const QString& /*arg1*/)
 {
-    // We append star at the beginning and at the end by default (makes property filtering much more practical)
-    const QString pattern = QRegularExpression::wildcardToRegularExpression("*" + arg1 + "*");
-    QRegularExpression regex(pattern, QRegularExpression::CaseInsensitiveOption);
-
-    for (int i = 0; i < ui->list->count(); ++i)
-    {
-        auto listItem = ui->list->item(i);
-        auto matchResult = regex.match(listItem->text());
-        listItem->setHidden(!matchResult.hasMatch());
-    }
+    // Filtering thousands of images on each keystroke stalls typing, wait until the user pauses
+    _filterTimer->start();
 }
 
-void ImagesetEditorDockWidget::on_list_itemChanged(QListWidgetItem* item)
+void ImagesetEditorDockWidget::onFilterTimeout()
 {
-    auto entry = item->data(Qt::UserRole + 2).value<ImageEntry*>();
-    if (!entry) return;
+    _listFilterModel->setFilterPattern(ui->filterBox->text());
+}
 
+void ImagesetEditorDockWidget::onImageRenameRequested(ImageEntry* entry, const QString& newName)
+{
     auto oldName = entry->name();
-    auto newName = item->text();
 
     // Most likely caused by RenameCommand doing it's work or is bogus anyways
     if (oldName == newName) return;
@@ -277,10 +292,17 @@ void ImagesetEditorDockWidget::on_list_itemChanged(QListWidgetItem* item)
     _visualMode.getEditor().getUndoStack()->push(new ImageRenameCommand(_visualMode, oldName, newName));
 }
 
-void ImagesetEditorDockWidget::on_list_itemSelectionChanged()
+void ImagesetEditorDockWidget::onListSelectionChanged()
 {
-    auto imageEntryNames = ui->list->selectedItems();
-    setActiveImageEntry(imageEntryNames.empty() ? nullptr : imageEntryNames[0]->data(Qt::UserRole + 2).value<ImageEntry*>());
+    const auto selectedIndices = ui->list->selectionModel()->selectedIndexes();
+
+    std::vector<ImageEntry*> selectedEntries;
+    selectedEntries.reserve(static_cast<size_t>(selectedIndices.size()));
+    for (const QModelIndex& index : selectedIndices)
+        if (ImageEntry* imageEntry = _listModel->getImageEntry(_listFilterModel->mapToSource(index)))
+            selectedEntries.push_back(imageEntry);
+
+    setActiveImageEntry(selectedEntries.empty() ? nullptr : selectedEntries[0]);
 
     // We are getting synchronised with the visual editing pane, do not interfere
     if (selectionSynchronizationUnderway) return;
@@ -289,18 +311,11 @@ void ImagesetEditorDockWidget::on_list_itemSelectionChanged()
 
     _visualMode.scene()->clearSelection();
 
-    auto imageEntryItems = ui->list->selectedItems();
-    for (auto&& imageEntryItem : imageEntryItems)
-    {
-        auto imageEntry = imageEntryItem->data(Qt::UserRole + 2).value<ImageEntry*>();
+    for (ImageEntry* imageEntry : selectedEntries)
         imageEntry->setSelected(true);
-    }
 
-    if (imageEntryItems.size() == 1)
-    {
-        auto imageEntry = imageEntryItems[0]->data(Qt::UserRole + 2).value<ImageEntry*>();
-        _visualMode.centerOn(imageEntry);
-    }
+    if (selectedEntries.size() == 1)
+        _visualMode.centerOn(selectedEntries[0]);
 
     selectionUnderway = false;
 }
@@ -8,7 +8,9 @@
 class ImagesetEntry;
 class ImageEntry;
 class ImagesetVisualMode;
-class QListWidgetItem;
+class ImageListModel;
+class ImageListFilterModel;
+class QTimer;
 
 namespace Ui {
 class ImagesetEditorDockWidget;
@@ -30,6 +32,8 @@ public:
     void refreshImagesetInfo();
     void refresh();
     void scrollToEntry(ImageEntry* entry);
+    void updateImageEntryItem(ImageEntry* entry);
+    void setImageEntrySelected(ImageEntry* entry, bool selected);
 
     bool isSelectionUnderway() const { return selectionUnderway; }
     void setSelectionSynchronizationUnderway(bool on) { selectionSynchronizationUnderway = on; }
@@ -53,9 +57,11 @@ private slots:
 
     void on_filterBox_textChanged(const QString &arg1);
 
-    void on_list_itemChanged(QListWidgetItem *item);
+    void onFilterTimeout();
 
-    void on_list_itemSelectionChanged();
+    void onImageRenameRequested(ImageEntry* entry, const QString& newName);
+
+    void onListSelectionChanged();
 
     void on_positionX_textChanged(const QString &arg1);
 
@@ -82,6 +88,9 @@ private:
     ImagesetVisualMode& _visualMode;
     ImagesetEntry* imagesetEntry = nullptr;
     ImageEntry* activeImageEntry = nullptr;
+    ImageListModel* _listModel = nullptr;
+    ImageListFilterModel* _listFilterModel = nullptr;
+    QTimer* _filterTimer = nullptr; // Debounces filtering while the user is typing
 
     bool selectionUnderway = false;
     bool selectionSynchronizationUnderway = false;
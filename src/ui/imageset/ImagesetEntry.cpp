@@ -1,6 +1,8 @@
 #include "src/ui/imageset/ImagesetEntry.h"
 #include "src/ui/imageset/ImageEntry.h"
 #include "src/editors/imageset/ImagesetVisualMode.h"
+#include "src/ui/TiledImageItem.h"
+#include "src/util/ImageService.h"
 #include "src/util/Utils.h"
 #include "src/Application.h"
 #include "qfilesystemwatcher.h"
@@ -10,19 +12,26 @@
 #include "qdir.h"
 #include "qdom.h"
 #include "qpen.h"
+#include <unordered_set>
+#include <algorithm>
 
 ImagesetEntry::ImagesetEntry(ImagesetVisualMode& visualMode)
     : QObject(&visualMode)
-    , QGraphicsPixmapItem() // Top-level item
+    , QGraphicsItem() // Top-level item
     , _visualMode(visualMode)
 {
-    setShapeMode(BoundingRectShape);
     setCursor(Qt::ArrowCursor);
 
     transparencyBackground = new QGraphicsRectItem(this);
     transparencyBackground->setFlags(ItemStacksBehindParent);
     transparencyBackground->setBrush(Utils::getCheckerboardBrush());
     transparencyBackground->setPen(QPen(QColor(Qt::transparent)));
+
+    // Created after the background, so it is stacked above it but still behind image entries
+    imageItem = new TiledImageItem(this);
+    imageItem->setFlags(ItemStacksBehindParent);
+
+    connect(&ImageService::Instance(), &ImageService::imageLoaded, this, &ImagesetEntry::onImageLoaded);
 }
 
 ImagesetEntry::~ImagesetEntry()
@@ -51,6 +60,7 @@ void ImagesetEntry::loadFromElement(const QDomElement& xml)
         ImageEntry* image = new ImageEntry(this);
         image->loadFromElement(xmlImage);
         imageEntries.push_back(image);
+        addToNameIndex(image, image->name());
 
         xmlImage = xmlImage.nextSiblingElement("Image");
     }
@@ -80,37 +90,46 @@ ImageEntry*ImagesetEntry::createImageEntry()
 {
     ImageEntry* image = new ImageEntry(this);
     imageEntries.push_back(image);
+    addToNameIndex(image, image->name());
     return image;
 }
 
 ImageEntry* ImagesetEntry::getImageEntry(const QString& name) const
 {
-    auto it = std::find_if(imageEntries.begin(), imageEntries.end(), [&name](ImageEntry* ent)
-    {
-        return ent->name() == name;
-    });
+    auto it = imageEntriesByName.find(name);
 
-    //assert(it != imageEntries.end());
-    return (it != imageEntries.end()) ? (*it) : nullptr;
+    //assert(it != imageEntriesByName.end());
+    return (it != imageEntriesByName.end()) ? it->second : nullptr;
 }
 
-void ImagesetEntry::removeImageEntry(const QString& name)
+// Removes all images in one pass over the list, so that deleting many images doesn't take quadratic time
+void ImagesetEntry::removeImageEntries(const std::vector<QString>& names)
 {
-    auto it = std::find_if(imageEntries.begin(), imageEntries.end(), [&name](ImageEntry* ent)
+    std::unordered_set<ImageEntry*> imagesToRemove;
+    for (const QString& name : names)
     {
-        return ent->name() == name;
-    });
+        // Duplicated names refer to different images, each lookup finds the next one
+        ImageEntry* image = getImageEntry(name);
+        if (!image) continue;
 
-    if (it == imageEntries.end()) return;
-
-    ImageEntry* image = (*it);
+        removeFromNameIndex(image, name);
+        imagesToRemove.insert(image);
+    }
 
-    imageEntries.erase(it);
+    if (imagesToRemove.empty()) return;
 
-    image->setParentItem(nullptr);
-    _visualMode.scene()->removeItem(image);
+    // The order of images is preserved in the saved file, so entries are erased in place
+    imageEntries.erase(std::remove_if(imageEntries.begin(), imageEntries.end(), [&imagesToRemove](ImageEntry* image)
+    {
+        return imagesToRemove.find(image) != imagesToRemove.end();
+    }), imageEntries.end());
 
-    delete image;
+    for (ImageEntry* image : imagesToRemove)
+    {
+        image->setParentItem(nullptr);
+        _visualMode.scene()->removeItem(image);
+        delete image;
+    }
 }
 
 // Monitor the image with a QFilesystemWatcher, ask user to reload if changes to the file were made
@@ -151,11 +170,32 @@ void ImagesetEntry::loadImage(const QString& absPath)
 
     _imageAbsPath = absPath;
 
-    setPixmap(_imageAbsPath.isEmpty() ? QPixmap() : QPixmap(absPath));
+    // Decoding of huge atlases takes long, the image is applied when it is ready
+    if (_imageAbsPath.isEmpty())
+        onImageLoaded(_imageAbsPath, QImage());
+    else
+        ImageService::Instance().loadImage(_imageAbsPath);
+
+    if (!imageMonitor)
+    {
+        imageMonitor = new QFileSystemWatcher();
+        connect(imageMonitor, &QFileSystemWatcher::fileChanged, this, &ImagesetEntry::onImageChangedByExternalProgram);
+    }
+    if (!_imageAbsPath.isEmpty())
+        imageMonitor->addPath(absPath);
+}
+
+void ImagesetEntry::onImageLoaded(const QString& absPath, const QImage& image)
+{
+    // The image might have been changed again while this one was being decoded
+    if (absPath != _imageAbsPath) return;
+
+    prepareGeometryChange();
+    imageItem->setImage(image);
     transparencyBackground->setRect(boundingRect());
 
     // Go over all image entries and set their position to force them to be constrained
-    // to the new pixmap's dimensions
+    // to the new image's dimensions
     for (auto& imageEntry : imageEntries)
     {
         imageEntry->setPos(imageEntry->pos());
@@ -163,12 +203,51 @@ void ImagesetEntry::loadImage(const QString& absPath)
     }
 
     _visualMode.refreshSceneRect();
+}
 
-    if (!imageMonitor)
+const QImage& ImagesetEntry::getImage() const
+{
+    return imageItem->getImage();
+}
+
+bool ImagesetEntry::hasImage() const
+{
+    return !imageItem->getImage().isNull();
+}
+
+QRectF ImagesetEntry::boundingRect() const
+{
+    return imageItem->boundingRect();
+}
+
+// The image itself is drawn by the child item
+void ImagesetEntry::paint(QPainter* /*painter*/, const QStyleOptionGraphicsItem* /*option*/, QWidget* /*widget*/)
+{
+}
+
+// Called by the image itself, so that every way of renaming keeps the index valid
+void ImagesetEntry::onImageEntryRenamed(ImageEntry* image, const QString& oldName)
+{
+    // Images being loaded are renamed before they are added
+    if (removeFromNameIndex(image, oldName))
+        addToNameIndex(image, image->name());
+}
+
+void ImagesetEntry::addToNameIndex(ImageEntry* image, const QString& name)
+{
+    imageEntriesByName.emplace(name, image);
+}
+
+bool ImagesetEntry::removeFromNameIndex(ImageEntry* image, const QString& name)
+{
+    auto range = imageEntriesByName.equal_range(name);
+    for (auto it = range.first; it != range.second; ++it)
     {
-        imageMonitor = new QFileSystemWatcher();
-        connect(imageMonitor, &QFileSystemWatcher::fileChanged, this, &ImagesetEntry::onImageChangedByExternalProgram);
+        if (it->second == image)
+        {
+            imageEntriesByName.erase(it);
+            return true;
+        }
     }
-    if (!_imageAbsPath.isEmpty())
-        imageMonitor->addPath(absPath);
+    return false;
 }
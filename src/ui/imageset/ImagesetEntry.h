@@ -2,17 +2,21 @@
 #define IMAGESETENTRY_H
 
 #include "qgraphicsitem.h"
+#include "src/QtStdHash.h"
+#include <unordered_map>
 
 // This is the whole imageset containing all the images (ImageEntries).
 // The main reason for this is not to have multiple imagesets editing at once but rather
 // to have the transparency background working properly.
 
 class QDomElement;
+class QImage;
 class ImageEntry;
 class QFileSystemWatcher;
 class ImagesetVisualMode;
+class TiledImageItem;
 
-class ImagesetEntry : public QObject, public QGraphicsPixmapItem
+class ImagesetEntry : public QObject, public QGraphicsItem
 {
     Q_OBJECT
 
@@ -24,6 +28,11 @@ public:
     void loadFromElement(const QDomElement& xml);
     void saveToElement(QDomElement& xml);
     void loadImage(const QString& absPath);
+    const QImage& getImage() const;
+    bool hasImage() const;
+
+    virtual QRectF boundingRect() const override;
+    virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
 
     QString name() const { return _name; }
     void setName(const QString& newName) { _name = newName; }
@@ -35,8 +44,10 @@ public:
 
     ImageEntry* createImageEntry();
     ImageEntry* getImageEntry(const QString& name) const;
-    void removeImageEntry(const QString& name);
+    void removeImageEntry(const QString& name) { removeImageEntries({ name }); }
+    void removeImageEntries(const std::vector<QString>& names);
     const std::vector<ImageEntry*>& getImageEntries() const { return imageEntries; }
+    void onImageEntryRenamed(ImageEntry* image, const QString& oldName);
 
     bool showOffsets() const { return _showOffsets; }
     void setShowOffsets(bool value) { _showOffsets = value; }
@@ -46,6 +57,7 @@ public:
 protected slots:
 
     void onImageChangedByExternalProgram();
+    void onImageLoaded(const QString& absPath, const QImage& image);
 
 protected:
 
@@ -58,9 +70,16 @@ protected:
     int nativeVertRes = 600;
     bool _showOffsets = false;
 
+    void addToNameIndex(ImageEntry* image, const QString& name);
+    bool removeFromNameIndex(ImageEntry* image, const QString& name);
+
     std::vector<ImageEntry*> imageEntries;
 
+    // Lookup by name for undo commands. Names may be duplicated temporarily while the user edits them.
+    std::unordered_multimap<QString, ImageEntry*> imageEntriesByName;
+
     QGraphicsRectItem* transparencyBackground = nullptr;
+    TiledImageItem* imageItem = nullptr; // Draws the image in tiles, huge atlases would be slow as a single pixmap
 
     //???here or in MainWindow?
     QFileSystemWatcher* imageMonitor = nullptr;
@@ -1,12 +1,17 @@
 #include "src/ui/layout/CreateWidgetDockWidget.h"
 #include "src/cegui/CEGUIManager.h"
 #include "ui_CreateWidgetDockWidget.h"
+#include <qtimer.h>
+
+static const int PreviewsPerSlice = 4;
 
 CreateWidgetDockWidget::CreateWidgetDockWidget(QWidget *parent) :
     QDockWidget(parent),
     ui(new Ui::CreateWidgetDockWidget)
 {
     ui->setupUi(this);
+
+    connect(ui->tree, &QTreeWidget::itemExpanded, this, &CreateWidgetDockWidget::onItemExpanded);
 }
 
 CreateWidgetDockWidget::~CreateWidgetDockWidget()
@@ -17,6 +22,7 @@ CreateWidgetDockWidget::~CreateWidgetDockWidget()
 void CreateWidgetDockWidget::populate()
 {
     ui->tree->clear();
+    _pendingPreviewTypes.clear();
 
     std::map<QString, QStringList> widgetsBySkin;
     CEGUIManager::Instance().getAvailableWidgetsBySkin(widgetsBySkin);
@@ -24,6 +30,7 @@ void CreateWidgetDockWidget::populate()
     for (auto& pair : widgetsBySkin)
     {
         QTreeWidgetItem* skinItem;
+        QStringList previewTypes;
         if (pair.first == "__no_skin__")
         {
             skinItem = ui->tree->invisibleRootItem();
@@ -44,6 +51,40 @@ void CreateWidgetDockWidget::populate()
             auto widgetItem = new QTreeWidgetItem();
             widgetItem->setText(0, widget);
             skinItem->addChild(widgetItem);
+
+            // TabButton is an autowidget, it can't be previewed without a parent
+            if (pair.first != "__no_skin__" && widget != "TabButton")
+                previewTypes.push_back(pair.first + "/" + widget);
         }
+
+        if (skinItem != ui->tree->invisibleRootItem())
+            skinItem->setData(0, Qt::UserRole, previewTypes);
+    }
+}
+
+// Tooltips render missing previews on demand. When the user opens a skin, its previews are prepared
+// a few per event loop iteration, so that tooltips show up instantly without blocking the UI.
+void CreateWidgetDockWidget::onItemExpanded(QTreeWidgetItem* item)
+{
+    _pendingPreviewTypes.append(item->data(0, Qt::UserRole).toStringList());
+    if (_pendingPreviewTypes.empty() || _previewPreparationScheduled) return;
+
+    _previewPreparationScheduled = true;
+    QTimer::singleShot(0, this, &CreateWidgetDockWidget::preparePendingPreviews);
+}
+
+void CreateWidgetDockWidget::preparePendingPreviews()
+{
+    _previewPreparationScheduled = false;
+    if (_pendingPreviewTypes.empty()) return;
+
+    const QStringList slice = _pendingPreviewTypes.mid(0, PreviewsPerSlice);
+    _pendingPreviewTypes.erase(_pendingPreviewTypes.begin(), _pendingPreviewTypes.begin() + slice.size());
+    CEGUIManager::Instance().prepareWidgetPreviews(slice);
+
+    if (!_pendingPreviewTypes.empty())
+    {
+        _previewPreparationScheduled = true;
+        QTimer::singleShot(0, this, &CreateWidgetDockWidget::preparePendingPreviews);
     }
 }
@@ -2,6 +2,9 @@
 #define CREATEWIDGETDOCKWIDGET_H
 
 #include <QDockWidget>
+#include <QStringList>
+
+class QTreeWidgetItem;
 
 // This lists available widgets you can create and allows their creation (by drag N drop)
 
@@ -20,9 +23,17 @@ public:
 
     void populate();
 
+private slots:
+
+    void onItemExpanded(QTreeWidgetItem* item);
+    void preparePendingPreviews();
+
 private:
 
     Ui::CreateWidgetDockWidget *ui;
+
+    QStringList _pendingPreviewTypes;
+    bool _previewPreparationScheduled = false;
 };
 
 #endif // CREATEWIDGETDOCKWIDGET_H
@@ -47,6 +47,9 @@ LayoutManipulator::LayoutManipulator(LayoutVisualMode& visualMode, QGraphicsItem
     if (isLayoutContainer())
         _lcHandle = new LayoutContainerHandle(*this);
 
+    if (auto parentManipulator = dynamic_cast<LayoutManipulator*>(parent))
+        _visualMode.getScene()->onManipulatorChildrenChanged(parentManipulator);
+
     QObject::connect(_visualMode.getAbsoluteModeAction(), &QAction::toggled, [this]
     {
         // Immediately update if possible
@@ -140,6 +143,7 @@ void LayoutManipulator::notifyResizeProgress(QPointF newPos, QSizeF newSize)
     CEGUIManipulator::notifyResizeProgress(newPos, newSize);
     _lastNewPos = newPos;
     _lastNewSize = newSize;
+    _visualMode.getScene()->onManipulatorGeometryChanged(this);
 }
 
 void LayoutManipulator::notifyResizeFinished(QPointF newPos, QSizeF newSize)
@@ -192,13 +196,13 @@ void LayoutManipulator::updateFromWidget(bool callUpdate, bool updateAncestorLCs
     bool hoverable = true;
     if (_widget->isAutoWindow())
     {
-        auto&& settings = qobject_cast<Application*>(qApp)->getSettings();
+        auto scene = _visualMode.getScene();
 
         // Don't show outlines unless instructed to do so
-        if (!settings->getEntryValue("layout/visual/auto_widgets_show_outline").toBool())
+        if (!scene->getAutoWidgetsShowOutline())
             _showOutline = false;
 
-        if (!settings->getEntryValue("layout/visual/auto_widgets_selectable").toBool())
+        if (!scene->getAutoWidgetsSelectable())
         {
             // Make this widget non-interactive
             currFlags |= (ItemHasNoContents | ItemStacksBehindParent);
@@ -259,9 +263,13 @@ void LayoutManipulator::updateFromWidget(bool callUpdate, bool updateAncestorLCs
 void LayoutManipulator::detach(bool detachWidget, bool destroyWidget, bool recursive)
 {
     const bool isRoot = (_visualMode.getScene()->getRootWidgetManipulator() == this);
+    auto parentManipulator = dynamic_cast<LayoutManipulator*>(parentItem());
 
     CEGUIManipulator::detach(detachWidget, destroyWidget, recursive);
 
+    // Indices of remaining siblings have changed
+    if (parentManipulator) _visualMode.getScene()->onManipulatorChildrenChanged(parentManipulator);
+
     if (_treeItem)
     {
         auto index = _treeItem->index();
@@ -279,6 +287,11 @@ bool LayoutManipulator::preventManipulatorOverlap() const
     return settings->getEntryValue("layout/visual/prevent_manipulator_overlap").toBool();
 }
 
+QPainterPath LayoutManipulator::getOverlapClipPath() const
+{
+    return _visualMode.getScene()->getManipulatorOverlapClipPath(this);
+}
+
 bool LayoutManipulator::useAbsoluteCoordsForMove() const
 {
     return _visualMode.isAbsoluteMode();
@@ -604,10 +617,29 @@ QVariant LayoutManipulator::itemChange(QGraphicsItem::GraphicsItemChange change,
     {
         _visualMode.getScene()->onManipulatorRemoved(this);
     }
+    else if (change == ItemPositionHasChanged)
+    {
+        _visualMode.getScene()->onManipulatorGeometryChanged(this);
+    }
+    else if (change == ItemParentHasChanged)
+    {
+        if (auto parentManipulator = dynamic_cast<LayoutManipulator*>(parentItem()))
+            _visualMode.getScene()->onManipulatorChildrenChanged(parentManipulator);
+        onStackingChanged();
+    }
+    else if (change == ItemVisibleHasChanged || change == ItemZValueHasChanged)
+    {
+        onStackingChanged();
+    }
 
     return CEGUIManipulator::itemChange(change, value);
 }
 
+void LayoutManipulator::onStackingChanged()
+{
+    _visualMode.getScene()->onManipulatorStackingChanged();
+}
+
 void LayoutManipulator::onPropertyChanged(const QtnPropertyBase* property, CEGUI::Property* ceguiProperty)
 {
     QString value;
@@ -36,6 +36,7 @@ public:
     virtual void detach(bool detachWidget = true, bool destroyWidget = true, bool recursive = true) override;
 
     virtual bool preventManipulatorOverlap() const override;
+    virtual QPainterPath getOverlapClipPath() const override;
     virtual bool useAbsoluteCoordsForMove() const override;
     virtual bool useAbsoluteCoordsForResize() const override;
     virtual bool useIntegersForAbsoluteMove() const override;
@@ -68,6 +69,7 @@ protected:
     virtual QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
     virtual void onPropertyChanged(const QtnPropertyBase* changedProperty, CEGUI::Property* ceguiProperty) override;
     virtual void onWidgetNameChanged() override;
+    virtual void onStackingChanged() override;
 
     virtual QPen getNormalPen() const override;
     virtual QPen getHoverPen() const override;
@@ -0,0 +1,177 @@
+#include "src/ui/layout/LayoutOverlapIndex.h"
+#include "src/ui/layout/LayoutManipulator.h"
+#include <qgraphicsscene.h>
+#include <set>
+#include <algorithm>
+#include <cmath>
+
+// Size of the grid cell in scene pixels. Most widgets are smaller than that, so they touch 1-4 cells.
+static const qreal GridCellSize = 256.0;
+
+static inline qint64 getCellKey(int x, int y)
+{
+    return (static_cast<qint64>(x) << 32) | static_cast<quint32>(y);
+}
+
+LayoutOverlapIndex::LayoutOverlapIndex(QGraphicsScene& scene)
+    : _scene(scene)
+{
+}
+
+// Called when manipulator is moved or resized. Stacking order and visibility are not affected.
+void LayoutOverlapIndex::onGeometryChanged(const LayoutManipulator* manipulator)
+{
+    // Will be rebuilt from scratch anyway
+    if (_dirty) return;
+
+    auto it = _entries.find(manipulator);
+    if (it == _entries.end())
+    {
+        // Newly created manipulator, its rank is unknown
+        _dirty = true;
+        return;
+    }
+
+    // Descendants are moved along with the manipulator, it is simpler to rebuild than to track them all
+    for (QGraphicsItem* item : manipulator->childItems())
+    {
+        if (dynamic_cast<LayoutManipulator*>(item))
+        {
+            _dirty = true;
+            return;
+        }
+    }
+
+    Entry& entry = it->second;
+    const QRectF newRect = manipulator->sceneBoundingRect();
+    if (newRect == entry.rect) return;
+
+    if (entry.visible)
+    {
+        removeFromGrid(manipulator, entry.rect);
+        addToGrid(manipulator, newRect);
+    }
+
+    // Manipulators under the old and the new position must recalculate their clipping
+    invalidateClipPaths(entry.rect);
+    invalidateClipPaths(newRect);
+
+    entry.rect = newRect;
+    entry.clipPathValid = false;
+}
+
+QPainterPath LayoutOverlapIndex::getClipPath(const LayoutManipulator* manipulator)
+{
+    QPainterPath clipPath;
+    clipPath.addRect(_scene.sceneRect());
+
+    if (_dirty) rebuild();
+
+    auto it = _entries.find(manipulator);
+    if (it == _entries.end()) return clipPath;
+
+    Entry& entry = it->second;
+    if (entry.clipPathValid) return entry.clipPath;
+
+    // Only manipulators sharing grid cells with us can overlap. Large ones are registered
+    // in many cells so we must process each of them only once.
+    std::set<const LayoutManipulator*> processed;
+    QPainterPath abovePath;
+    abovePath.setFillRule(Qt::WindingFill);
+    forEachCell(entry.rect, [&](qint64 key)
+    {
+        auto cellIt = _grid.find(key);
+        if (cellIt == _grid.end()) return;
+
+        for (const LayoutManipulator* other : cellIt->second)
+        {
+            if (other == manipulator) continue;
+
+            const Entry& otherEntry = _entries[other];
+            if (otherEntry.rank >= entry.rank || !otherEntry.rect.intersects(entry.rect)) continue;
+
+            if (processed.insert(other).second)
+                abovePath.addRect(otherEntry.rect);
+        }
+    });
+
+    entry.clipPath = abovePath.isEmpty() ? clipPath : clipPath.subtracted(abovePath);
+    entry.clipPathValid = true;
+    return entry.clipPath;
+}
+
+void LayoutOverlapIndex::rebuild()
+{
+    _entries.clear();
+    _grid.clear();
+
+    // Items are returned in descending stacking order, the topmost one goes first
+    size_t rank = 0;
+    for (QGraphicsItem* item : _scene.items())
+    {
+        auto manipulator = dynamic_cast<LayoutManipulator*>(item);
+        if (!manipulator) continue;
+
+        Entry& entry = _entries[manipulator];
+        entry.rank = rank++;
+        entry.rect = manipulator->sceneBoundingRect();
+        entry.visible = manipulator->isVisible();
+        if (entry.visible) addToGrid(manipulator, entry.rect);
+    }
+
+    _dirty = false;
+}
+
+void LayoutOverlapIndex::addToGrid(const LayoutManipulator* manipulator, const QRectF& rect)
+{
+    forEachCell(rect, [this, manipulator](qint64 key)
+    {
+        _grid[key].push_back(manipulator);
+    });
+}
+
+void LayoutOverlapIndex::removeFromGrid(const LayoutManipulator* manipulator, const QRectF& rect)
+{
+    forEachCell(rect, [this, manipulator](qint64 key)
+    {
+        auto cellIt = _grid.find(key);
+        if (cellIt == _grid.end()) return;
+
+        auto& cell = cellIt->second;
+        auto it = std::find(cell.begin(), cell.end(), manipulator);
+        if (it != cell.end())
+        {
+            *it = cell.back();
+            cell.pop_back();
+        }
+
+        if (cell.empty()) _grid.erase(cellIt);
+    });
+}
+
+void LayoutOverlapIndex::invalidateClipPaths(const QRectF& rect)
+{
+    forEachCell(rect, [this, &rect](qint64 key)
+    {
+        auto cellIt = _grid.find(key);
+        if (cellIt == _grid.end()) return;
+
+        for (const LayoutManipulator* other : cellIt->second)
+        {
+            Entry& otherEntry = _entries[other];
+            if (otherEntry.rect.intersects(rect))
+                otherEntry.clipPathValid = false;
+        }
+    });
+}
+
+void LayoutOverlapIndex::forEachCell(const QRectF& rect, std::function<void(qint64)> callback) const
+{
+    const int minX = static_cast<int>(std::floor(rect.left() / GridCellSize));
+    const int maxX = static_cast<int>(std::floor(rect.right() / GridCellSize));
+    const int minY = static_cast<int>(std::floor(rect.top() / GridCellSize));
+    const int maxY = static_cast<int>(std::floor(rect.bottom() / GridCellSize));
+    for (int y = minY; y <= maxY; ++y)
+        for (int x = minX; x <= maxX; ++x)
+            callback(getCellKey(x, y));
+}
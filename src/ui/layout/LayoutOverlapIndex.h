@@ -0,0 +1,51 @@
+#ifndef LAYOUTOVERLAPINDEX_H
+#define LAYOUTOVERLAPINDEX_H
+
+#include <qpainterpath.h>
+#include <unordered_map>
+#include <vector>
+#include <functional>
+
+// Spatial index of layout manipulators used for clipping overlapping outlines. Scene rects are bucketed
+// into a uniform grid and stacking order is cached as ranks, so a clip path is built only from manipulators
+// that can actually overlap. Clip paths are cached and rebuilt only when the scene changes, not on each paint.
+
+class QGraphicsScene;
+class LayoutManipulator;
+
+class LayoutOverlapIndex
+{
+public:
+
+    LayoutOverlapIndex(QGraphicsScene& scene);
+
+    void invalidate() { _dirty = true; }
+    void onGeometryChanged(const LayoutManipulator* manipulator);
+
+    // Returns a scene space clip path that excludes manipulators stacked above the given one
+    QPainterPath getClipPath(const LayoutManipulator* manipulator);
+
+protected:
+
+    struct Entry
+    {
+        QRectF rect;
+        QPainterPath clipPath;
+        size_t rank = 0; // 0 is the topmost manipulator
+        bool visible = false;
+        bool clipPathValid = false;
+    };
+
+    void rebuild();
+    void addToGrid(const LayoutManipulator* manipulator, const QRectF& rect);
+    void removeFromGrid(const LayoutManipulator* manipulator, const QRectF& rect);
+    void invalidateClipPaths(const QRectF& rect);
+    void forEachCell(const QRectF& rect, std::function<void(qint64)> callback) const;
+
+    QGraphicsScene& _scene;
+    std::unordered_map<const LayoutManipulator*, Entry> _entries;
+    std::unordered_map<qint64, std::vector<const LayoutManipulator*>> _grid;
+    bool _dirty = true;
+};
+
+#endif // LAYOUTOVERLAPINDEX_H
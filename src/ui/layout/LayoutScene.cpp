@@ -13,6 +13,7 @@
 #include "src/editors/layout/LayoutUndoCommands.h"
 #include "src/cegui/CEGUIManager.h" //!!!for OpenGL context! TODO: encapsulate?
 #include "src/cegui/CEGUIUtils.h"
+#include "src/util/FrameProfiler.h"
 #include <CEGUI/CoordConverter.h>
 #include <CEGUI/GUIContext.h>
 #include <CEGUI/widgets/TabControl.h>
@@ -24,7 +25,13 @@
 #include <qstandarditemmodel.h>
 #include <qmenu.h>
 #include <qscreen.h>
+#include <qtimer.h>
+#include <qitemselectionmodel.h>
+#include <qelapsedtimer.h>
 #include <set>
+#include <algorithm>
+#include <iterator>
+#include <limits>
 
 // For properties (may be incapsulated somewhere):
 #include "src/ui/MainWindow.h"
@@ -34,16 +41,21 @@
 #include <QtnProperty/PropertyView.h>
 #include <QtnProperty/MultiProperty.h>
 
+static const qint64 FirstManipulatorBuildSliceNs = 50000000; // Layouts built within it open without a visible progress
+static const qint64 ManipulatorBuildSliceNs = 10000000;
+
 LayoutScene::LayoutScene(LayoutVisualMode& visualMode)
     : CEGUIGraphicsScene(&visualMode)
     , _visualMode(visualMode)
+    , _overlapIndex(*this)
 {
     connect(this, &LayoutScene::selectionChanged, this, &LayoutScene::onSelectionChanged);
+    updateCachedSettings();
 }
 
 LayoutScene::~LayoutScene()
 {
-    if (_multiSet) _multiSet->clearChildProperties();
+    resetShownPropertySets();
     disconnect(this, &LayoutScene::selectionChanged, this, &LayoutScene::onSelectionChanged);
     delete _anchorPopupMenu;
 }
@@ -200,6 +212,7 @@ void LayoutScene::setupActionsForTabControl()
             {
                 clearSelection();
                 tab->setSelected(true);
+                flushSelectionChange();
                 qobject_cast<Application*>(qApp)->getMainWindow()->focusOnProperty(*props.begin());
             }
         });
@@ -280,13 +293,256 @@ void LayoutScene::setupActionsForTabControl()
 
 void LayoutScene::updateFromWidgets()
 {
+    updateCachedSettings();
     if (_rootManipulator) _rootManipulator->updateFromWidget();
 }
 
+void LayoutScene::updateCachedSettings()
+{
+    auto&& settings = qobject_cast<Application*>(qApp)->getSettings();
+    _autoWidgetsShowOutline = settings->getEntryValue("layout/visual/auto_widgets_show_outline").toBool();
+    _autoWidgetsSelectable = settings->getEntryValue("layout/visual/auto_widgets_selectable").toBool();
+}
+
+// Postpones updateFromWidget(callUpdate, true) of the manipulator until the next frame. Many changes
+// inside one layout container or in nested widgets result in a single update of each affected subtree.
+void LayoutScene::scheduleGeometryUpdate(LayoutManipulator* manipulator, bool callUpdate)
+{
+    if (!manipulator) return;
+
+    auto it = _geometryUpdateQueue.find(manipulator);
+    if (it == _geometryUpdateQueue.end())
+        _geometryUpdateQueue.emplace(manipulator, callUpdate);
+    else if (callUpdate)
+        it->second = true;
+
+    if (!_geometryUpdateScheduled)
+    {
+        _geometryUpdateScheduled = true;
+        QTimer::singleShot(0, this, &LayoutScene::flushGeometryUpdates);
+    }
+}
+
+// Applies postponed geometry updates immediately, call it when manipulator geometry must be actual
+void LayoutScene::flushGeometryUpdates()
+{
+    FrameProfiler::Scope profileScope("Geometry updates");
+
+    _geometryUpdateScheduled = false;
+    if (_geometryUpdateQueue.empty()) return;
+
+    // Updates may lead to new requests, they will be processed in the next flush
+    std::unordered_map<LayoutManipulator*, bool> queue;
+    std::swap(queue, _geometryUpdateQueue);
+
+    // Layout containers relayout all their contents, so the topmost one of nested LCs is updated instead
+    // of its children. Such an update always includes a widget update, the same as updateFromWidget does.
+    std::unordered_map<LayoutManipulator*, bool> roots;
+    for (const auto& pair : queue)
+    {
+        LayoutManipulator* target = pair.first;
+        bool callUpdate = pair.second;
+        for (auto item = pair.first->parentItem(); item; item = item->parentItem())
+        {
+            auto manipulator = dynamic_cast<LayoutManipulator*>(item);
+            if (!manipulator || !manipulator->isLayoutContainer()) break;
+            target = manipulator;
+            callUpdate = true;
+        }
+
+        auto it = roots.find(target);
+        if (it == roots.end())
+            roots.emplace(target, callUpdate);
+        else if (callUpdate)
+            it->second = true;
+    }
+
+    // An update is recursive, skip manipulators whose ancestor is updated too
+    std::vector<std::pair<int, LayoutManipulator*>> updates; // Depth -> manipulator
+    updates.reserve(roots.size());
+    for (auto& pair : roots)
+    {
+        LayoutManipulator* topmostQueuedAncestor = nullptr;
+        int depth = 0;
+        for (auto item = pair.first->parentItem(); item; item = item->parentItem())
+        {
+            ++depth;
+            if (auto manipulator = dynamic_cast<LayoutManipulator*>(item))
+                if (roots.find(manipulator) != roots.end())
+                    topmostQueuedAncestor = manipulator;
+        }
+
+        if (topmostQueuedAncestor)
+        {
+            // The flag is inherited by descendants in the recursive update
+            if (pair.second) roots[topmostQueuedAncestor] = true;
+        }
+        else
+        {
+            updates.emplace_back(depth, pair.first);
+        }
+    }
+
+    updateCachedSettings();
+
+    // Top-down order. Parents are updated before children anyway, but this makes updates deterministic.
+    std::sort(updates.begin(), updates.end());
+    for (const auto& pair : updates)
+        pair.second->updateFromWidget(roots[pair.second], false);
+}
+
+static size_t countDescendantWidgets(const CEGUI::Window& widget)
+{
+    size_t count = widget.getChildCount();
+    for (size_t i = 0; i < widget.getChildCount(); ++i)
+        count += countDescendantWidgets(*widget.getChildAtIndex(i));
+    return count;
+}
+
+// Creates descendant manipulators of the manipulator in time slices, so that huge layouts become interactive
+// before their hierarchy is complete. Subtrees in the visible part of the scene are built first, others
+// breadth-first. The first slice runs immediately, most layouts are built completely within it.
+void LayoutScene::buildChildManipulatorsProgressively(LayoutManipulator* manipulator)
+{
+    if (!manipulator) return;
+
+    ManipulatorBuildEntry entry;
+    entry.manipulator = manipulator;
+    entry.id = ++_nextManipulatorBuildEntryId;
+    if (!manipulator->getChildWidgetCount()) return;
+
+    if (!isBuildingManipulators())
+    {
+        _manipulatorsBuilt = 0;
+        _manipulatorsToBuild = 0;
+    }
+
+    _manipulatorsToBuild += countDescendantWidgets(*manipulator->getWidget());
+    _manipulatorBuildEntryIds[manipulator] = entry.id;
+    _manipulatorBuildQueue.push_back(std::move(entry));
+
+    // Batch tools have no use for progressive loading and expect the hierarchy to be complete
+    if (!CEGUIManager::Instance().isInteractive())
+    {
+        finishBuildingManipulators();
+        return;
+    }
+
+    if (!buildManipulators(FirstManipulatorBuildSliceNs) && !_manipulatorBuildScheduled)
+    {
+        _manipulatorBuildScheduled = true;
+        QTimer::singleShot(0, this, &LayoutScene::continueBuildingManipulators);
+    }
+
+    updateStatusMessage();
+}
+
+// Builds all remaining manipulators, call it when the complete hierarchy is required. Must also be called before
+// any change of the widget hierarchy, because building walks children of each widget by index.
+void LayoutScene::finishBuildingManipulators()
+{
+    if (!isBuildingManipulators()) return;
+
+    buildManipulators(std::numeric_limits<qint64>().max());
+    updateStatusMessage();
+}
+
+// Loading of the layout is abandoned by the user. The editor can't be used with a partial hierarchy, so it is closed.
+void LayoutScene::cancelBuildingManipulators()
+{
+    if (!isBuildingManipulators()) return;
+
+    _manipulatorBuildQueue.clear();
+    _manipulatorBuildEntryIds.clear();
+
+    auto mainWindow = qobject_cast<Application*>(qApp)->getMainWindow();
+    mainWindow->setStatusMessage("");
+
+    // Not from inside of our own event handler
+    EditorBase* editor = &_visualMode.getEditor();
+    QTimer::singleShot(0, mainWindow, [mainWindow, editor]() { mainWindow->closeEditorTab(editor); });
+}
+
+void LayoutScene::continueBuildingManipulators()
+{
+    _manipulatorBuildScheduled = false;
+    if (!isBuildingManipulators()) return;
+
+    if (!buildManipulators(ManipulatorBuildSliceNs))
+    {
+        _manipulatorBuildScheduled = true;
+        QTimer::singleShot(0, this, &LayoutScene::continueBuildingManipulators);
+    }
+
+    if (qobject_cast<Application*>(qApp)->getMainWindow()->getCurrentEditor() == &_visualMode.getEditor())
+        updateStatusMessage();
+}
+
+// Returns true when there is nothing left to build
+bool LayoutScene::buildManipulators(qint64 timeBudgetNs)
+{
+    FrameProfiler::Scope profileScope("Manipulator building");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QRectF visibleRect;
+    if (!views().empty())
+        visibleRect = views()[0]->mapToScene(views()[0]->viewport()->rect()).boundingRect();
+
+    size_t builtInSlice = 0;
+    while (!_manipulatorBuildQueue.empty())
+    {
+        ManipulatorBuildEntry& entry = _manipulatorBuildQueue.front();
+
+        auto itId = _manipulatorBuildEntryIds.find(entry.manipulator);
+        const bool isValid = (itId != _manipulatorBuildEntryIds.end() && itId->second == entry.id);
+        if (!isValid || entry.nextChild >= entry.manipulator->getChildWidgetCount())
+        {
+            if (isValid) _manipulatorBuildEntryIds.erase(itId);
+            _manipulatorBuildQueue.pop_front();
+            continue;
+        }
+
+        // The entry may be invalidated by pushing to the queue below
+        LayoutManipulator* parent = entry.manipulator;
+        CEGUI::Window* childWidget = parent->getChildWidgetAtIndex(entry.nextChild++);
+        if (!parent->shouldCreateChildManipulator(childWidget, false)) continue;
+
+        auto childManipulator = parent->createChildManipulator(childWidget);
+        childManipulator->updateFromWidget();
+        ++_manipulatorsBuilt;
+
+        if (childManipulator->getChildWidgetCount())
+        {
+            ManipulatorBuildEntry childEntry;
+            childEntry.manipulator = childManipulator;
+            childEntry.id = ++_nextManipulatorBuildEntryId;
+            _manipulatorBuildEntryIds[childManipulator] = childEntry.id;
+
+            // Visible subtrees are built depth-first before the rest of the siblings
+            if (childManipulator->sceneBoundingRect().intersects(visibleRect))
+                _manipulatorBuildQueue.push_front(std::move(childEntry));
+            else
+                _manipulatorBuildQueue.push_back(std::move(childEntry));
+        }
+
+        // Reading the clock is not free, check it once per a small batch
+        if ((++builtInSlice % 32) == 0 && timer.nsecsElapsed() >= timeBudgetNs) break;
+    }
+
+    if (!_manipulatorBuildQueue.empty()) return false;
+
+    _manipulatorBuildEntryIds.clear();
+    _manipulatorsToBuild = 0;
+    return true;
+}
+
 // Overridden to keep the manipulators in sync
 void LayoutScene::setCEGUIDisplaySize(float width, float height)
 {
     CEGUIGraphicsScene::setCEGUIDisplaySize(width, height);
+    _overlapIndex.invalidate();
     updateFromWidgets();
 }
 
@@ -298,13 +554,19 @@ void LayoutScene::setRootWidgetManipulator(LayoutManipulator* manipulator)
     _anchorTarget = nullptr;
     _anchorSnapTarget = nullptr;
 
-    if (_multiSet) _multiSet->clearChildProperties();
+    resetShownPropertySets();
 
     // Clear scene without reacting on selection changes. Will update once at the end when items recreated.
     disconnect(this, &LayoutScene::selectionChanged, this, &LayoutScene::onSelectionChanged);
     clear();
     connect(this, &LayoutScene::selectionChanged, this, &LayoutScene::onSelectionChanged);
 
+    _overlapIndex.invalidate();
+    _manipulatorsByPath.clear();
+    _pathsByManipulator.clear();
+    _geometryUpdateQueue.clear();
+    _manipulatorBuildQueue.clear();
+    _manipulatorBuildEntryIds.clear();
     _rootManipulator = manipulator;
 
     if (_rootManipulator)
@@ -316,6 +578,7 @@ void LayoutScene::setRootWidgetManipulator(LayoutManipulator* manipulator)
 
         // Root manipulator changed, perform a full update
         // NB: widget must be already set to a CEGUI context for area calculation
+        updateCachedSettings();
         _rootManipulator->updateFromWidget(true);
         addItem(_rootManipulator);
 
@@ -349,17 +612,54 @@ LayoutManipulator* LayoutScene::getManipulatorByPath(const QString& widgetPath)
 {
     if (!_rootManipulator || widgetPath.isEmpty()) return nullptr;
 
+    auto it = _manipulatorsByPath.find(widgetPath);
+    if (it != _manipulatorsByPath.end())
+    {
+        // The cached manipulator might have changed its path since then
+        if (it->second->getWidgetPath() == widgetPath) return it->second;
+
+        _pathsByManipulator.erase(it->second);
+        _manipulatorsByPath.erase(it);
+    }
+
+    LayoutManipulator* manipulator = nullptr;
     auto sepPos = widgetPath.indexOf('/');
     if (sepPos < 0)
     {
         assert(widgetPath == _rootManipulator->getWidgetName());
-        return _rootManipulator;
+        manipulator = _rootManipulator;
     }
     else
     {
         assert(widgetPath.leftRef(sepPos) == _rootManipulator->getWidgetName());
-        return dynamic_cast<LayoutManipulator*>(_rootManipulator->getManipulatorByPath(widgetPath.mid(sepPos + 1)));
+        manipulator = dynamic_cast<LayoutManipulator*>(_rootManipulator->getManipulatorByPath(widgetPath.mid(sepPos + 1)));
     }
+
+    // The manipulator may be not created yet if the layout is still loading
+    if (!manipulator && isBuildingManipulators())
+    {
+        const_cast<LayoutScene*>(this)->finishBuildingManipulators();
+        return getManipulatorByPath(widgetPath);
+    }
+
+    if (manipulator)
+    {
+        // Only the latest path of the manipulator is kept
+        auto itPath = _pathsByManipulator.find(manipulator);
+        if (itPath != _pathsByManipulator.end())
+        {
+            _manipulatorsByPath.erase(itPath->second);
+            itPath->second = widgetPath;
+        }
+        else
+        {
+            _pathsByManipulator.emplace(manipulator, widgetPath);
+        }
+
+        _manipulatorsByPath.emplace(widgetPath, manipulator);
+    }
+
+    return manipulator;
 }
 
 bool LayoutScene::deleteWidgetByPath(const QString& widgetPath)
@@ -369,10 +669,9 @@ bool LayoutScene::deleteWidgetByPath(const QString& widgetPath)
 
     auto mainWindow = qobject_cast<Application*>(qApp)->getMainWindow();
     auto propertyWidget = static_cast<QtnPropertyWidget*>(mainWindow->getPropertyDockWidget()->widget());
-    if (propertyWidget->propertySet() == manipulator->getPropertySet())
+    if (manipulator->hasPropertySet() && propertyWidget->propertySet() == manipulator->getPropertySet())
         propertyWidget->setPropertySet(nullptr);
-    if (_multiSet)
-        _multiSet->clearChildProperties();
+    resetShownPropertySets();
 
     auto parentManipulator = dynamic_cast<LayoutManipulator*>(manipulator->parentItem());
 
@@ -400,24 +699,64 @@ void LayoutScene::updatePropertySet()
     updatePropertySet(selectedWidgets);
 }
 
+// Reverts qtnPropertiesToMultiSet for one source set, multiproperties left without sources are deleted
+static void removePropertiesFromMultiSet(QtnPropertySet* target, QtnPropertySet* source)
+{
+    for (auto property : source->childProperties())
+    {
+        // Same matching as in qtnPropertiesToMultiSet
+        const auto& targetProperties = target->childProperties();
+        auto it = std::find_if(targetProperties.begin(), targetProperties.end(), [property](const QtnPropertyBase* targetProperty)
+        {
+            return property->propertyMetaObject() == targetProperty->propertyMetaObject() &&
+                    property->displayName() == targetProperty->displayName();
+        });
+
+        if (it == targetProperties.end()) continue;
+
+        QtnPropertyBase* targetProperty = *it;
+        bool isEmpty = false;
+        if (auto subSet = property->asPropertySet())
+        {
+            auto multiSubSet = targetProperty->asPropertySet();
+            removePropertiesFromMultiSet(multiSubSet, subSet);
+            isEmpty = !multiSubSet->hasChildProperties();
+        }
+        else
+        {
+            auto multiProperty = static_cast<QtnMultiProperty*>(targetProperty);
+            multiProperty->removeProperty(property->asProperty());
+            isEmpty = multiProperty->getProperties().empty();
+        }
+
+        if (isEmpty)
+        {
+            target->removeChildProperty(targetProperty);
+            delete targetProperty;
+        }
+    }
+}
+
 void LayoutScene::updatePropertySet(const std::set<LayoutManipulator*>& selectedWidgets)
 {
+    FrameProfiler::Scope profileScope("Property set update");
+
     auto mainWindow = qobject_cast<Application*>(qApp)->getMainWindow();
     auto propertyWidget = static_cast<QtnPropertyWidget*>(mainWindow->getPropertyDockWidget()->widget());
 
     disconnect(propertyWidget->propertyView(), &QtnPropertyView::beforePropertyEdited, this, &LayoutScene::onBeforePropertyEdited);
 
-    if (_multiSet)
-    {
-        // Unset our multiset from the widget to avoid freeze due to contents change
-        if (propertyWidget->propertySet() == _multiSet)
-            propertyWidget->setPropertySet(nullptr);
-        _multiSet->clearChildProperties();
-    }
+    // Unset our multiset from the widget to avoid freeze due to contents change
+    if (_multiSet && propertyWidget->propertySet() == _multiSet)
+        propertyWidget->setPropertySet(nullptr);
 
     if (selectedWidgets.size() == 1)
     {
+        resetShownPropertySets();
+
         auto selectedWidget = *selectedWidgets.begin();
+        selectedWidget->setPropertySetPinned(true);
+        _shownPropertySetOwners.insert(selectedWidget);
         propertyWidget->setPropertySet(selectedWidget->getPropertySet());
     }
     else if (selectedWidgets.size() > 1)
@@ -426,19 +765,59 @@ void LayoutScene::updatePropertySet(const std::set<LayoutManipulator*>& selected
 
         if (!_multiSet) _multiSet = new QtnPropertySet(this);
 
-        for (LayoutManipulator* manipulator : selectedWidgets)
+        // Extending or shrinking the multiselection touches only changed widgets
+        std::vector<LayoutManipulator*> removed;
+        std::vector<LayoutManipulator*> added;
+        if (_shownPropertySetOwners.size() > 1)
+        {
+            std::set_difference(_shownPropertySetOwners.begin(), _shownPropertySetOwners.end(),
+                                selectedWidgets.begin(), selectedWidgets.end(), std::back_inserter(removed));
+            std::set_difference(selectedWidgets.begin(), selectedWidgets.end(),
+                                _shownPropertySetOwners.begin(), _shownPropertySetOwners.end(), std::back_inserter(added));
+        }
+
+        // Rebuilding is cheaper when the selection changed too much
+        if (_shownPropertySetOwners.size() <= 1 || removed.size() + added.size() >= selectedWidgets.size())
+        {
+            resetShownPropertySets();
+            removed.clear();
+            added.assign(selectedWidgets.begin(), selectedWidgets.end());
+        }
+
+        for (LayoutManipulator* manipulator : removed)
+        {
+            removePropertiesFromMultiSet(_multiSet, manipulator->getPropertySet());
+            manipulator->setPropertySetPinned(false);
+            _shownPropertySetOwners.erase(manipulator);
+        }
+
+        for (LayoutManipulator* manipulator : added)
+        {
             qtnPropertiesToMultiSet(_multiSet, manipulator->getPropertySet(), false);
+            manipulator->setPropertySetPinned(true);
+            _shownPropertySetOwners.insert(manipulator);
+        }
 
         propertyWidget->setPropertySet(_multiSet);
     }
     else
     {
+        resetShownPropertySets();
         propertyWidget->setPropertySet(nullptr);
     }
 
     updatePropertyWidgetTitle(selectedWidgets);
 }
 
+void LayoutScene::resetShownPropertySets()
+{
+    if (_multiSet) _multiSet->clearChildProperties();
+
+    for (LayoutManipulator* manipulator : _shownPropertySetOwners)
+        manipulator->setPropertySetPinned(false);
+    _shownPropertySetOwners.clear();
+}
+
 void LayoutScene::updatePropertyWidgetTitle(const std::set<LayoutManipulator*>& selectedWidgets)
 {
     auto propertyDockWidget = qobject_cast<Application*>(qApp)->getMainWindow()->getPropertyDockWidget();
@@ -711,12 +1090,36 @@ void LayoutScene::selectParent()
 void LayoutScene::onManipulatorRemoved(LayoutManipulator* manipulator)
 {
     if (_anchorTarget == manipulator) _anchorTarget = nullptr;
+
+    _geometryUpdateQueue.erase(manipulator);
+    _manipulatorBuildEntryIds.erase(manipulator);
+
+    auto itPath = _pathsByManipulator.find(manipulator);
+    if (itPath != _pathsByManipulator.end())
+    {
+        _manipulatorsByPath.erase(itPath->second);
+        _pathsByManipulator.erase(itPath);
+    }
+
+    if (auto hierarchyDockWidget = _visualMode.getHierarchyDockWidget())
+        hierarchyDockWidget->onManipulatorRemoved(manipulator);
+
+    _overlapIndex.invalidate();
+}
+
+// Children of the manipulator were added, removed or reordered
+void LayoutScene::onManipulatorChildrenChanged(LayoutManipulator* manipulator)
+{
+    if (auto hierarchyDockWidget = _visualMode.getHierarchyDockWidget())
+        hierarchyDockWidget->onManipulatorChildrenChanged(manipulator);
 }
 
 void LayoutScene::onManipulatorUpdatedFromWidget(LayoutManipulator* manipulator)
 {
     if (!manipulator) return;
 
+    _overlapIndex.onGeometryChanged(manipulator);
+
     // Update anchor handles for the manipulator if they are shown,
     // unless updateFromWidget() was called due to dragging them
     if (_anchorTarget == manipulator)
@@ -776,6 +1179,11 @@ void LayoutScene::updateStatusMessage()
                         + "</i> as a sibling of selected <i>" + _anchorTarget->getWidgetName() + "</i>";
         }
     }
+    else if (isBuildingManipulators())
+    {
+        helpMsg = QString("Loading layout: %1 of %2 widgets, press <b>Esc</b> to cancel")
+                .arg(_manipulatorsBuilt).arg(std::max(_manipulatorsBuilt, _manipulatorsToBuild));
+    }
 
     qobject_cast<Application*>(qApp)->getMainWindow()->setStatusMessage(helpMsg);
 }
@@ -837,6 +1245,8 @@ static void ensureParentIsExpanded(QTreeView* view, QStandardItem* treeItem)
 
 void LayoutScene::onSelectionChanged()
 {
+    FrameProfiler::Scope profileScope("Selection change");
+
     if (_batchSelection) return;
 
     std::set<LayoutManipulator*> selectedWidgets;
@@ -865,13 +1275,9 @@ void LayoutScene::onSelectionChanged()
     }
     else if (selectedWidgets.size() == 0)
     {
-        if (selectedAnchorItem)
-        {
-            // If we selected anchor item, we therefore deselected an _anchorTarget,
-            // but it must look as selected in a GUI, so we don't change anything
-            selectedWidgets.insert(_anchorTarget);
-        }
-        else
+        // If we selected anchor item, we therefore deselected an _anchorTarget,
+        // but it must look as selected in a GUI, so we don't change anything
+        if (!selectedAnchorItem)
         {
             // Nothing interesting is selected, hide anchors
             _anchorTarget = nullptr;
@@ -890,34 +1296,66 @@ void LayoutScene::onSelectionChanged()
 
     updateAnchorItems();
 
-    // Update property view for our selection
+    // Property view and hierarchy tree are updated once per event loop turn, because
+    // e.g. rubber band selection changes the selection on each mouse move
 
-    updatePropertySet(selectedWidgets);
+    if (!_ignoreSelectionChanges) _treeSelectionSyncPending = true;
 
-    // Show selection in a hierarchy tree
+    if (!_selectionChangePending)
+    {
+        _selectionChangePending = true;
+        QTimer::singleShot(0, this, &LayoutScene::flushSelectionChange);
+    }
+}
 
-    if (!_ignoreSelectionChanges)
+// Applies a postponed selection change immediately, call it when the property view must be actual
+void LayoutScene::flushSelectionChange()
+{
+    if (!_selectionChangePending) return;
+    _selectionChangePending = false;
+
+    std::set<LayoutManipulator*> selectedWidgets;
+    collectSelectedWidgets(selectedWidgets);
+
+    // Selected anchor item deselects its target, but it must look as selected in a GUI
+    if (selectedWidgets.empty() && _anchorTarget && getCurrentAnchorItem())
+        selectedWidgets.insert(_anchorTarget);
+
+    updatePropertySet(selectedWidgets);
+
+    if (_treeSelectionSyncPending)
     {
-        _visualMode.getHierarchyDockWidget()->ignoreSelectionChanges(true);
+        _treeSelectionSyncPending = false;
+        syncHierarchyTreeSelection(selectedWidgets);
+    }
+}
+
+void LayoutScene::syncHierarchyTreeSelection(const std::set<LayoutManipulator*>& selectedWidgets)
+{
+    FrameProfiler::Scope profileScope("Hierarchy selection sync");
+
+    _visualMode.getHierarchyDockWidget()->ignoreSelectionChanges(true);
 
-        auto treeView = _visualMode.getHierarchyDockWidget()->getTreeView();
-        treeView->clearSelection();
+    auto treeView = _visualMode.getHierarchyDockWidget()->getTreeView();
 
-        QStandardItem* lastTreeItem = nullptr;
-        for (LayoutManipulator* manipulator : selectedWidgets)
+    // Select all at once, each separate selection change is expensive for the tree
+    QItemSelection selection;
+    QStandardItem* lastTreeItem = nullptr;
+    for (LayoutManipulator* manipulator : selectedWidgets)
+    {
+        if (auto treeItem = manipulator->getTreeItem())
         {
-            if (auto treeItem = manipulator->getTreeItem())
-            {
-                treeView->selectionModel()->select(treeItem->index(), QItemSelectionModel::Select);
-                ensureParentIsExpanded(treeView, treeItem);
-                lastTreeItem = treeItem;
-            }
+            selection.select(treeItem->index(), treeItem->index());
+            ensureParentIsExpanded(treeView, treeItem);
+            lastTreeItem = treeItem;
         }
+    }
 
-        if (lastTreeItem) treeView->scrollTo(lastTreeItem->index());
+    treeView->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect);
 
-        _visualMode.getHierarchyDockWidget()->ignoreSelectionChanges(false);
-    }
+    if (lastTreeItem) treeView->scrollTo(lastTreeItem->index());
+
+    _visualMode.getHierarchyDockWidget()->ignoreSelectionChanges(false);
 }
 
 void LayoutScene::onBeforePropertyEdited()
@@ -1626,7 +2064,12 @@ void LayoutScene::keyReleaseEvent(QKeyEvent* event)
     }
     else if (event->key() == Qt::Key_Escape)
     {
-        if (!selectedItems().isEmpty())
+        if (isBuildingManipulators())
+        {
+            cancelBuildingManipulators();
+            handled = true;
+        }
+        else if (!selectedItems().isEmpty())
         {
             clearSelection();
             handled = true;
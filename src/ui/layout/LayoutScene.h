@@ -2,10 +2,14 @@
 #define LAYOUTSCENE_H
 
 #include "src/ui/CEGUIGraphicsScene.h"
+#include "src/ui/layout/LayoutOverlapIndex.h"
 #include <CEGUI/HorizontalAlignment.h>
 #include <CEGUI/VerticalAlignment.h>
+#include "src/QtStdHash.h"
 #include <qmenu.h>
 #include <set>
+#include <deque>
+#include <unordered_map>
 
 // This scene contains all the manipulators users want to interact it. You can visualise it as the
 // visual editing centre screen where CEGUI is rendered.
@@ -19,6 +23,11 @@ class NumericValueItem;
 class QtnPropertySet;
 class AnchorPopupMenu;
 
+namespace CEGUI
+{
+    class Window;
+}
+
 class LayoutScene : public CEGUIGraphicsScene
 {
     Q_OBJECT
@@ -40,13 +49,26 @@ public:
     void updatePropertySet();
     void updatePropertySet(const std::set<LayoutManipulator*>& selectedWidgets);
     void updatePropertyWidgetTitle(const std::set<LayoutManipulator*>& selectedWidgets);
+    void flushSelectionChange();
+    void scheduleGeometryUpdate(LayoutManipulator* manipulator, bool callUpdate = false);
+    void flushGeometryUpdates();
+    bool getAutoWidgetsShowOutline() const { return _autoWidgetsShowOutline; }
+    void buildChildManipulatorsProgressively(LayoutManipulator* manipulator);
+    void finishBuildingManipulators();
+    void cancelBuildingManipulators();
+    bool isBuildingManipulators() const { return !_manipulatorBuildQueue.empty(); }
+    bool getAutoWidgetsSelectable() const { return _autoWidgetsSelectable; }
 
     void alignSelectionHorizontally(CEGUI::HorizontalAlignment alignment);
     void alignSelectionVertically(CEGUI::VerticalAlignment alignment);
     void moveSelectedWidgetsInParentWidgetLists(int delta);
 
     void onManipulatorRemoved(LayoutManipulator* manipulator);
+    void onManipulatorChildrenChanged(LayoutManipulator* manipulator);
     void onManipulatorUpdatedFromWidget(LayoutManipulator* manipulator);
+    void onManipulatorGeometryChanged(LayoutManipulator* manipulator) { _overlapIndex.onGeometryChanged(manipulator); }
+    void onManipulatorStackingChanged() { _overlapIndex.invalidate(); }
+    QPainterPath getManipulatorOverlapClipPath(const LayoutManipulator* manipulator) { return _overlapIndex.getClipPath(manipulator); }
     void onManipulatorDragEnter(LayoutManipulator* manipulator);
     void onManipulatorDragLeave(LayoutManipulator* manipulator);
     void anchorHandleMoved(QGraphicsItem* item, QPointF& newPos, bool moveOpposite);
@@ -86,6 +108,11 @@ public slots:
 protected:
 
     void createAnchorItems();
+    void resetShownPropertySets();
+    void updateCachedSettings();
+    void continueBuildingManipulators();
+    bool buildManipulators(qint64 timeBudgetNs);
+    void syncHierarchyTreeSelection(const std::set<LayoutManipulator*>& selectedWidgets);
 
     void setupActionsForTabControl();
 
@@ -104,9 +131,34 @@ protected:
     LayoutVisualMode& _visualMode;
     LayoutManipulator* _rootManipulator = nullptr;
 
+    // Path lookup cache. Entries are verified on access because renaming or reparenting changes
+    // paths of the whole subtree, and are removed when manipulators leave the scene.
+    mutable std::unordered_map<QString, LayoutManipulator*> _manipulatorsByPath;
+    mutable std::unordered_map<const LayoutManipulator*, QString> _pathsByManipulator;
+
     QtnPropertySet* _multiSet = nullptr;
+    std::set<LayoutManipulator*> _shownPropertySetOwners; // Their property sets are pinned. If more than one, _multiSet is built of them.
     size_t _multiChangeId = 0;
 
+    LayoutOverlapIndex _overlapIndex;
+
+    // Manipulators whose geometry must be re-read from widgets, with the 'callUpdate' flag. Flushed once per frame.
+    std::unordered_map<LayoutManipulator*, bool> _geometryUpdateQueue;
+
+    // Child widgets still waiting for their manipulators while a huge layout is being loaded. Entries of
+    // manipulators removed from the scene are invalidated through _manipulatorBuildEntryIds.
+    struct ManipulatorBuildEntry
+    {
+        LayoutManipulator* manipulator = nullptr;
+        size_t nextChild = 0; // Children are read from the widget when built, the hierarchy may change meanwhile
+        quint64 id = 0;
+    };
+    std::deque<ManipulatorBuildEntry> _manipulatorBuildQueue;
+    std::unordered_map<const LayoutManipulator*, quint64> _manipulatorBuildEntryIds;
+    quint64 _nextManipulatorBuildEntryId = 0;
+    size_t _manipulatorsBuilt = 0;
+    size_t _manipulatorsToBuild = 0; // Approximate, for progress reporting only
+
     AnchorPopupMenu* _anchorPopupMenu = nullptr;
     QMenu* _contextMenu = nullptr;
     std::map<QString, std::vector<std::pair<QAction*, std::function<bool()>>>> _widgetActions; // Widget type -> {action + condition}
@@ -133,6 +185,14 @@ protected:
 
     bool _ignoreSelectionChanges = false;
     bool _batchSelection = false;
+    bool _selectionChangePending = false;
+    bool _treeSelectionSyncPending = false;
+    bool _geometryUpdateScheduled = false;
+    bool _manipulatorBuildScheduled = false;
+
+    // Settings cached to avoid lookups for each manipulator updated
+    bool _autoWidgetsShowOutline = false;
+    bool _autoWidgetsSelectable = false;
 };
 
 #endif // LAYOUTSCENE_H
@@ -33,13 +33,23 @@ void WidgetHierarchyDockWidget::setRootWidgetManipulator(LayoutManipulator* root
     ui->treeView->expandToDepth(0);
 }
 
-// Refreshes the entire hierarchy completely from scratch. Also synchronize selection.
+// Applies pending hierarchy changes immediately, rebuilds the tree if the root has changed. Also synchronize selection.
 void WidgetHierarchyDockWidget::refresh()
 {
     static_cast<WidgetHierarchyTreeModel*>(ui->treeView->model())->setRootManipulator(_rootWidgetManipulator);
     _visualMode.getScene()->onSelectionChanged();
 }
 
+void WidgetHierarchyDockWidget::onManipulatorChildrenChanged(LayoutManipulator* manipulator)
+{
+    static_cast<WidgetHierarchyTreeModel*>(ui->treeView->model())->onChildrenChanged(manipulator);
+}
+
+void WidgetHierarchyDockWidget::onManipulatorRemoved(LayoutManipulator* manipulator)
+{
+    static_cast<WidgetHierarchyTreeModel*>(ui->treeView->model())->onManipulatorRemoved(manipulator);
+}
+
 QTreeView* WidgetHierarchyDockWidget::getTreeView() const
 {
     return ui->treeView;
@@ -27,6 +27,8 @@ public:
     LayoutVisualMode& getVisualMode() const { return _visualMode; }
     void setRootWidgetManipulator(LayoutManipulator* root);
     void refresh();
+    void onManipulatorChildrenChanged(LayoutManipulator* manipulator);
+    void onManipulatorRemoved(LayoutManipulator* manipulator);
 
     bool isIgnoringSelectionChanges() const { return _ignoreSelectionChanges; }
     void ignoreSelectionChanges(bool ignore) { _ignoreSelectionChanges = ignore; }
@@ -8,6 +8,9 @@
 #include <CEGUI/Window.h>
 #include <qmimedata.h>
 #include <qmessagebox.h>
+#include <qtimer.h>
+#include <unordered_map>
+#include <algorithm>
 
 WidgetHierarchyTreeModel::WidgetHierarchyTreeModel(LayoutVisualMode& visualMode)
     : _visualMode(visualMode)
@@ -109,71 +112,159 @@ bool WidgetHierarchyTreeModel::dropMimeData(const QMimeData* mimeData, Qt::DropA
 
 void WidgetHierarchyTreeModel::setRootManipulator(LayoutManipulator* rootManipulator)
 {
-    if (!rowCount() || !synchroniseSubtree(static_cast<WidgetHierarchyItem*>(item(0)), rootManipulator))
+    auto rootItem = rowCount() ? static_cast<WidgetHierarchyItem*>(item(0)) : nullptr;
+    if (rootItem && rootItem->getManipulator() == rootManipulator)
     {
-        clear();
-        if (rootManipulator) appendRow(constructSubtree(rootManipulator));
+        synchroniseChangedSubtrees();
+        return;
     }
 
-    sort(0);
+    // A new hierarchy is built from scratch
+    _changedParents.clear();
+    clear();
+    if (rootManipulator) appendRow(constructSubtree(rootManipulator));
 }
 
-// Attempts to synchronise subtree with given widget manipulator, returns false if impossible.
-// recursive - If True the synchronisation will recurse, trying to unify child widget hierarchy
-//             items with child manipulators (this is generally what you want to do).
-bool WidgetHierarchyTreeModel::synchroniseSubtree(WidgetHierarchyItem* item, LayoutManipulator* manipulator, bool recursive)
+// Changes are applied on idle unless synchronised explicitly, so that batch operations are processed at once
+void WidgetHierarchyTreeModel::onChildrenChanged(LayoutManipulator* manipulator)
 {
-    if (!item || !manipulator || item->getManipulator() != manipulator) return false;
+    if (!manipulator) return;
 
-    item->refreshPathData(false);
+    _changedParents.insert(manipulator);
 
-    if (recursive)
+    if (!_synchronisationScheduled)
     {
-        std::vector<LayoutManipulator*> manipulatorsToRecreate;
-        manipulator->getChildLayoutManipulators(manipulatorsToRecreate, false);
+        _synchronisationScheduled = true;
+        QTimer::singleShot(0, this, &WidgetHierarchyTreeModel::synchroniseChangedSubtrees);
+    }
+}
+
+// Unlinks manipulators from items that are about to be deleted
+static void resetTreeItems(WidgetHierarchyItem* item)
+{
+    if (auto manipulator = item->getManipulator())
+        if (manipulator->getTreeItem() == item)
+            manipulator->setTreeItem(nullptr);
+
+    for (int i = 0; i < item->rowCount(); ++i)
+        resetTreeItems(static_cast<WidgetHierarchyItem*>(item->child(i)));
+}
+
+static void getSortedChildren(LayoutManipulator* manipulator, std::vector<LayoutManipulator*>& outChildren)
+{
+    manipulator->getChildLayoutManipulators(outChildren, false);
+
+    outChildren.erase(std::remove_if(outChildren.begin(), outChildren.end(), [](LayoutManipulator* child)
+    {
+        return child->shouldBeSkipped();
+    }), outChildren.end());
+
+    std::vector<std::pair<size_t, LayoutManipulator*>> indexed;
+    indexed.reserve(outChildren.size());
+    for (LayoutManipulator* child : outChildren)
+        indexed.emplace_back(child->getWidgetIndexInParent(), child);
+
+    std::sort(indexed.begin(), indexed.end());
+
+    for (size_t i = 0; i < indexed.size(); ++i)
+        outChildren[i] = indexed[i].second;
+}
 
-        // We do NOT use range here because the rowCount might change while we are processing
-        int i = 0;
-        while (i < item->rowCount())
+// Applies only the minimal set of row insertions, removals and moves for changed parents. Items that
+// moved to another parent are reused with their entire subtrees, only their path data is refreshed.
+void WidgetHierarchyTreeModel::synchroniseChangedSubtrees()
+{
+    _synchronisationScheduled = false;
+
+    if (_changedParents.empty()) return;
+
+    // Take out rows that don't belong to changed parents anymore, they may be reused under a new parent
+    std::unordered_map<LayoutManipulator*, QList<QStandardItem*>> detachedRows;
+    for (LayoutManipulator* parent : _changedParents)
+    {
+        auto parentItem = parent->getTreeItem();
+        if (!parentItem) continue;
+
+        for (int i = parentItem->rowCount() - 1; i >= 0; --i)
         {
-            auto child = static_cast<WidgetHierarchyItem*>(item->child(i));
+            auto childManipulator = static_cast<WidgetHierarchyItem*>(parentItem->child(i))->getManipulator();
+            if (childManipulator->parentItem() != parent || childManipulator->shouldBeSkipped())
+                detachedRows.emplace(childManipulator, parentItem->takeRow(i));
+        }
+    }
+
+    std::vector<LayoutManipulator*> children;
+    for (LayoutManipulator* parent : _changedParents)
+    {
+        // Not shown, will be constructed as a part of the parent's subtree
+        auto parentItem = parent->getTreeItem();
+        if (!parentItem) continue;
 
-            auto it = std::find(manipulatorsToRecreate.begin(), manipulatorsToRecreate.end(), child->getManipulator());
-            if (it != manipulatorsToRecreate.end() && synchroniseSubtree(child, child->getManipulator(), true))
+        children.clear();
+        getSortedChildren(parent, children);
+
+        for (int i = 0; i < static_cast<int>(children.size()); ++i)
+        {
+            LayoutManipulator* childManipulator = children[static_cast<size_t>(i)];
+            WidgetHierarchyItem* childItem = childManipulator->getTreeItem();
+            if (childItem && childItem->parent() == parentItem)
             {
-                manipulatorsToRecreate.erase(it);
-                ++i;
+                const int row = childItem->row();
+                if (row != i) parentItem->insertRow(i, parentItem->takeRow(row));
             }
             else
             {
-                item->removeRow(i);
+                QList<QStandardItem*> row;
+                auto it = detachedRows.find(childManipulator);
+                if (it != detachedRows.end())
+                {
+                    row = std::move(it->second);
+                    detachedRows.erase(it);
+                }
+                else if (childItem && childItem->parent())
+                {
+                    // Moved from the parent that wasn't reported as changed
+                    row = childItem->parent()->takeRow(childItem->row());
+                }
+                else
+                {
+                    row.push_back(constructSubtree(childManipulator));
+                }
+
+                parentItem->insertRow(i, row);
+                static_cast<WidgetHierarchyItem*>(row[0])->refreshPathData(true);
             }
+
+            static_cast<WidgetHierarchyItem*>(parentItem->child(i))->refreshOrderingData(false, false);
         }
 
-        for (LayoutManipulator* childManipulator : manipulatorsToRecreate)
-            if (!childManipulator->shouldBeSkipped())
-                item->appendRow(constructSubtree(childManipulator));
+        // Normally all the rest was detached above
+        while (parentItem->rowCount() > static_cast<int>(children.size()))
+        {
+            const int lastRow = parentItem->rowCount() - 1;
+            resetTreeItems(static_cast<WidgetHierarchyItem*>(parentItem->child(lastRow)));
+            parentItem->removeRow(lastRow);
+        }
     }
 
-    item->refreshOrderingData(true, true);
+    // Rows that found no new parent are deleted
+    for (auto& pair : detachedRows)
+    {
+        resetTreeItems(static_cast<WidgetHierarchyItem*>(pair.second[0]));
+        qDeleteAll(pair.second);
+    }
 
-    return true;
+    _changedParents.clear();
 }
 
 WidgetHierarchyItem* WidgetHierarchyTreeModel::constructSubtree(LayoutManipulator* manipulator)
 {
     auto ret = new WidgetHierarchyItem(manipulator);
 
-    for (QGraphicsItem* item : manipulator->childItems())
-    {
-        LayoutManipulator* childManipulator = dynamic_cast<LayoutManipulator*>(item);
-        if (childManipulator && !childManipulator->shouldBeSkipped())
-        {
-            auto childSubtree = constructSubtree(childManipulator);
-            ret->appendRow(childSubtree);
-        }
-    }
+    std::vector<LayoutManipulator*> children;
+    getSortedChildren(manipulator, children);
+    for (LayoutManipulator* childManipulator : children)
+        ret->appendRow(constructSubtree(childManipulator));
 
     return ret;
 }
-
@@ -2,6 +2,7 @@
 #define WIDGETHIERARCHYTREEMODEL_H
 
 #include "qstandarditemmodel.h"
+#include <unordered_set>
 
 class WidgetHierarchyItem;
 class LayoutManipulator;
@@ -19,13 +20,20 @@ public:
     virtual bool dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column, const QModelIndex& parent) override;
 
     void setRootManipulator(LayoutManipulator* rootManipulator);
+    void synchroniseChangedSubtrees();
+
+    void onChildrenChanged(LayoutManipulator* manipulator);
+    void onManipulatorRemoved(LayoutManipulator* manipulator) { _changedParents.erase(manipulator); }
 
 protected:
 
-    bool synchroniseSubtree(WidgetHierarchyItem* item, LayoutManipulator* manipulator, bool recursive = true);
     WidgetHierarchyItem* constructSubtree(LayoutManipulator* manipulator);
 
     LayoutVisualMode& _visualMode;
+
+    // Manipulators whose children were added, removed or reordered since the last synchronisation
+    std::unordered_set<LayoutManipulator*> _changedParents;
+    bool _synchronisationScheduled = false;
 };
 
 #endif // WIDGETHIERARCHYTREEMODEL_H
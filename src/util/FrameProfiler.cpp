@@ -0,0 +1,172 @@
+#include "src/util/FrameProfiler.h"
+#include "qfile.h"
+#include "qtextstream.h"
+#include <algorithm>
+#include <cstring>
+
+static const size_t MaxEvents = 65536;
+static const size_t MaxFrameTimes = 600;
+
+FrameProfiler::FrameProfiler()
+{
+    _timer.start();
+}
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+    if (_enabled == enabled) return;
+
+    _enabled = enabled;
+    if (_enabled)
+    {
+        _events.reserve(MaxEvents);
+        _frameTimes.reserve(MaxFrameTimes);
+    }
+
+    emit enabledChanged(_enabled);
+}
+
+void FrameProfiler::clear()
+{
+    _events.clear();
+    _nextEvent = 0;
+    _frameTimes.clear();
+    _nextFrameTime = 0;
+}
+
+void FrameProfiler::addEvent(const char* name, qint64 startNs, qint64 durationNs)
+{
+    Event ev;
+    ev.name = name;
+    ev.startNs = startNs;
+    ev.durationNs = durationNs;
+    ev.frame = _frame;
+
+    if (_events.size() < MaxEvents)
+        _events.push_back(ev);
+    else
+        _events[_nextEvent] = ev;
+
+    _nextEvent = (_nextEvent + 1) % MaxEvents;
+}
+
+// A frame is one paint of a CEGUI view, events recorded since the previous frame belong to this one
+void FrameProfiler::endFrame(qint64 startNs, qint64 durationNs)
+{
+    addEvent("Frame", startNs, durationNs);
+
+    if (_frameTimes.size() < MaxFrameTimes)
+        _frameTimes.push_back(durationNs);
+    else
+        _frameTimes[_nextFrameTime] = durationNs;
+
+    _nextFrameTime = (_nextFrameTime + 1) % MaxFrameTimes;
+    ++_frame;
+}
+
+// Returns events in chronological order
+std::vector<FrameProfiler::Event> FrameProfiler::getEvents() const
+{
+    std::vector<Event> result;
+    result.reserve(_events.size());
+    if (_events.size() < MaxEvents)
+    {
+        result = _events;
+    }
+    else
+    {
+        result.insert(result.end(), _events.begin() + static_cast<std::ptrdiff_t>(_nextEvent), _events.end());
+        result.insert(result.end(), _events.begin(), _events.begin() + static_cast<std::ptrdiff_t>(_nextEvent));
+    }
+    return result;
+}
+
+// Returns durations of recent frames from the oldest to the newest
+std::vector<qint64> FrameProfiler::getFrameTimes() const
+{
+    std::vector<qint64> result;
+    result.reserve(_frameTimes.size());
+    if (_frameTimes.size() < MaxFrameTimes)
+    {
+        result = _frameTimes;
+    }
+    else
+    {
+        result.insert(result.end(), _frameTimes.begin() + static_cast<std::ptrdiff_t>(_nextFrameTime), _frameTimes.end());
+        result.insert(result.end(), _frameTimes.begin(), _frameTimes.begin() + static_cast<std::ptrdiff_t>(_nextFrameTime));
+    }
+    return result;
+}
+
+// Per-scope totals over the last frameCount frames, in order of the first appearance
+std::vector<FrameProfiler::Stats> FrameProfiler::getRecentStats(quint32 frameCount) const
+{
+    std::vector<Stats> result;
+
+    const quint32 firstFrame = (_frame > frameCount) ? (_frame - frameCount) : 0;
+    for (const Event& ev : getEvents())
+    {
+        if (ev.frame < firstFrame || ev.frame >= _frame) continue;
+
+        auto it = std::find_if(result.begin(), result.end(), [&ev](const Stats& stats)
+        {
+            return stats.name == ev.name || !std::strcmp(stats.name, ev.name);
+        });
+
+        if (it == result.end())
+        {
+            result.emplace_back();
+            it = std::prev(result.end());
+            it->name = ev.name;
+        }
+
+        it->totalNs += ev.durationNs;
+        it->maxNs = std::max(it->maxNs, ev.durationNs);
+        ++it->count;
+    }
+
+    return result;
+}
+
+bool FrameProfiler::exportCSV(const QString& filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+
+    QTextStream stream(&file);
+    stream << "frame,name,start_us,duration_us\n";
+    for (const Event& ev : getEvents())
+    {
+        stream << ev.frame << ',' << ev.name << ','
+               << QString::number(ev.startNs / 1000.0, 'f', 3) << ','
+               << QString::number(ev.durationNs / 1000.0, 'f', 3) << '\n';
+    }
+
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
+
+// Trace Event Format with complete ("X") events, nesting is restored by viewers from timestamps
+bool FrameProfiler::exportChromeTrace(const QString& filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+
+    QTextStream stream(&file);
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const Event& ev : getEvents())
+    {
+        if (!first) stream << ",\n";
+        first = false;
+
+        stream << "{\"name\":\"" << ev.name << "\",\"cat\":\"ceed\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+               << ",\"ts\":" << QString::number(ev.startNs / 1000.0, 'f', 3)
+               << ",\"dur\":" << QString::number(ev.durationNs / 1000.0, 'f', 3)
+               << ",\"args\":{\"frame\":" << ev.frame << "}}";
+    }
+    stream << "\n]}\n";
+
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
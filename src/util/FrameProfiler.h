@@ -0,0 +1,95 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include "qobject.h"
+#include "qelapsedtimer.h"
+#include <vector>
+
+// Frame time instrumentation of CEGUI views and editor code. Named scopes are recorded into a ring buffer
+// only while the profiler is enabled, otherwise a scope costs a single branch. Scope names must be string
+// literals. Must be used from the GUI thread only. Recorded data can be exported as CSV or as a Chrome
+// trace (chrome://tracing, Perfetto) to attribute time between CEGUI and the editor.
+
+class FrameProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    static FrameProfiler& Instance()
+    {
+        static FrameProfiler profiler;
+        return profiler;
+    }
+
+    class Scope
+    {
+    public:
+
+        Scope(const char* name)
+            : _name(FrameProfiler::Instance().isEnabled() ? name : nullptr)
+            , _start(_name ? FrameProfiler::Instance().now() : 0)
+        {
+        }
+
+        ~Scope()
+        {
+            if (_name) FrameProfiler::Instance().addEvent(_name, _start, FrameProfiler::Instance().now() - _start);
+        }
+
+    private:
+
+        const char* _name;
+        qint64 _start;
+    };
+
+    struct Event
+    {
+        const char* name = nullptr;
+        qint64 startNs = 0;
+        qint64 durationNs = 0;
+        quint32 frame = 0;
+    };
+
+    struct Stats
+    {
+        const char* name = nullptr;
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+        int count = 0;
+    };
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled; }
+    void clear();
+
+    qint64 now() const { return _timer.nsecsElapsed(); }
+    void addEvent(const char* name, qint64 startNs, qint64 durationNs);
+    void endFrame(qint64 startNs, qint64 durationNs);
+
+    quint32 getFrameIndex() const { return _frame; }
+    std::vector<Event> getEvents() const;
+    std::vector<qint64> getFrameTimes() const;
+    std::vector<Stats> getRecentStats(quint32 frameCount) const;
+
+    bool exportCSV(const QString& filePath) const;
+    bool exportChromeTrace(const QString& filePath) const;
+
+signals:
+
+    void enabledChanged(bool enabled);
+
+private:
+
+    FrameProfiler();
+
+    QElapsedTimer _timer;
+    std::vector<Event> _events; // Ring buffer
+    size_t _nextEvent = 0;
+    std::vector<qint64> _frameTimes; // Ring buffer
+    size_t _nextFrameTime = 0;
+    quint32 _frame = 0;
+    bool _enabled = false;
+};
+
+#endif // FRAMEPROFILER_H
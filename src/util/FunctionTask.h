@@ -0,0 +1,22 @@
+#ifndef FUNCTIONTASK_H
+#define FUNCTIONTASK_H
+
+#include "qrunnable.h"
+#include <functional>
+
+// Runs a function in a QThreadPool. The pool deletes the task when it is done.
+// QRunnable::create does the same but requires Qt 5.15.
+
+class FunctionTask : public QRunnable
+{
+public:
+
+    FunctionTask(std::function<void()> func) : _func(std::move(func)) {}
+    virtual void run() override { _func(); }
+
+private:
+
+    std::function<void()> _func;
+};
+
+#endif // FUNCTIONTASK_H
@@ -0,0 +1,71 @@
+#include "src/util/ImageService.h"
+#include "src/util/FunctionTask.h"
+#include "qfileinfo.h"
+#include "qdatetime.h"
+#include <algorithm>
+
+static const int MaxThumbnailCacheCostKB = 32 * 1024;
+
+ImageService::ImageService()
+    : _thumbnails(MaxThumbnailCacheCostKB)
+{
+    connect(this, &ImageService::imageDecoded, this, &ImageService::onImageDecoded, Qt::QueuedConnection);
+    connect(this, &ImageService::thumbnailDecoded, this, &ImageService::onThumbnailDecoded, Qt::QueuedConnection);
+}
+
+ImageService::~ImageService()
+{
+    _pool.clear();
+    _pool.waitForDone();
+}
+
+// Each call decodes the file again, so that changes made by external programs are picked up
+void ImageService::loadImage(const QString& absPath)
+{
+    _pool.start(new FunctionTask([this, absPath]()
+    {
+        const qint64 modificationTime = QFileInfo(absPath).lastModified().toMSecsSinceEpoch();
+        emit imageDecoded(absPath, QImage(absPath), modificationTime);
+    }));
+}
+
+QString ImageService::getThumbnailKey(const QString& absPath, const QRect& rect, const QSize& size) const
+{
+    auto it = _modificationTimes.find(absPath);
+    const qint64 modificationTime = (it != _modificationTimes.end()) ? it->second : 0;
+    return QString("%1|%2|%3,%4,%5,%6|%7x%8").arg(absPath).arg(modificationTime)
+            .arg(rect.x()).arg(rect.y()).arg(rect.width()).arg(rect.height())
+            .arg(size.width()).arg(size.height());
+}
+
+// Returns a null image if the thumbnail is not cached
+QImage ImageService::getThumbnail(const QString& key) const
+{
+    QImage* thumbnail = _thumbnails.object(key);
+    return thumbnail ? *thumbnail : QImage();
+}
+
+// The source is implicitly shared with the worker and must not be modified in place until the thumbnail is ready
+void ImageService::requestThumbnail(const QString& key, const QImage& source, const QRect& rect, const QSize& size)
+{
+    if (source.isNull() || rect.isEmpty()) return;
+    if (!_pendingThumbnails.insert(key).second) return;
+
+    _pool.start(new FunctionTask([this, key, source, rect, size]()
+    {
+        emit thumbnailDecoded(key, source.copy(rect).scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    }));
+}
+
+void ImageService::onImageDecoded(QString absPath, QImage image, qint64 modificationTime)
+{
+    _modificationTimes[absPath] = modificationTime;
+    emit imageLoaded(absPath, image);
+}
+
+void ImageService::onThumbnailDecoded(QString key, QImage thumbnail)
+{
+    _pendingThumbnails.erase(key);
+    _thumbnails.insert(key, new QImage(thumbnail), std::max(1, thumbnail.width() * thumbnail.height() * 4 / 1024));
+    emit thumbnailReady(key, thumbnail);
+}
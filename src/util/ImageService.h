@@ -0,0 +1,61 @@
+#ifndef IMAGESERVICE_H
+#define IMAGESERVICE_H
+
+#include "src/QtStdHash.h"
+#include "qobject.h"
+#include "qimage.h"
+#include "qcache.h"
+#include "qthreadpool.h"
+#include <unordered_map>
+#include <unordered_set>
+
+// Decodes image files and generates thumbnails of their sub-rects in a thread pool, so that opening and browsing
+// big imagesets never blocks the GUI. Results are delivered by signals in the GUI thread. Thumbnails are cached
+// by image path, rect, size and file modification time, so a reloaded file never shows outdated thumbnails.
+// Must be used from the GUI thread only.
+
+class ImageService : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    static ImageService& Instance()
+    {
+        static ImageService service;
+        return service;
+    }
+
+    virtual ~ImageService() override;
+
+    void loadImage(const QString& absPath);
+
+    QString getThumbnailKey(const QString& absPath, const QRect& rect, const QSize& size) const;
+    QImage getThumbnail(const QString& key) const;
+    void requestThumbnail(const QString& key, const QImage& source, const QRect& rect, const QSize& size);
+
+signals:
+
+    void imageLoaded(const QString& absPath, const QImage& image);
+    void thumbnailReady(const QString& key, const QImage& thumbnail);
+
+    // Emitted from worker threads
+    void imageDecoded(QString absPath, QImage image, qint64 modificationTime);
+    void thumbnailDecoded(QString key, QImage thumbnail);
+
+private slots:
+
+    void onImageDecoded(QString absPath, QImage image, qint64 modificationTime);
+    void onThumbnailDecoded(QString key, QImage thumbnail);
+
+private:
+
+    ImageService();
+
+    QThreadPool _pool;
+    std::unordered_map<QString, qint64> _modificationTimes; // Of the last decoded version of each file
+    mutable QCache<QString, QImage> _thumbnails;
+    std::unordered_set<QString> _pendingThumbnails;
+};
+
+#endif // IMAGESERVICE_H